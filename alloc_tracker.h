@@ -0,0 +1,110 @@
+#pragma once
+
+// Debug allocation counting. Build a game with -DSNAKE_TRACK_ALLOCATIONS
+// and every operator new and SDL_malloc/calloc/realloc is counted per
+// thread; a SteadyStateCheck around a tick or frame then exits with an
+// error if that tick or frame allocated. Without the flag the counters
+// are never touched and the checks compile to nothing.
+// Include this from exactly one translation unit: it replaces the global
+// operator new.
+
+#include <SDL2/SDL.h>
+#include <bits/stdc++.h>
+
+const uint32_t ALLOC_WARMUP = 10; // ticks or frames allowed to allocate first
+
+inline thread_local uint64_t threadAllocations = 0;
+
+#ifdef SNAKE_TRACK_ALLOCATIONS
+
+void* operator new(size_t size)
+{
+    threadAllocations++;
+    if (void* p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    free(p);
+}
+
+inline void* countingMalloc(size_t size)
+{
+    threadAllocations++;
+    return malloc(size);
+}
+
+inline void* countingCalloc(size_t count, size_t size)
+{
+    threadAllocations++;
+    return calloc(count, size);
+}
+
+inline void* countingRealloc(void* p, size_t size)
+{
+    threadAllocations++;
+    return realloc(p, size);
+}
+
+inline void countingFree(void* p)
+{
+    free(p);
+}
+
+// Must run before SDL_Init so SDL never frees memory it got elsewhere.
+inline void trackSdlAllocations()
+{
+    SDL_SetMemoryFunctions(countingMalloc, countingCalloc, countingRealloc, countingFree);
+}
+
+#else
+
+inline void trackSdlAllocations() {}
+
+#endif
+
+class SteadyStateCheck {
+public:
+    // passes counts how many ticks or frames have gone through this check.
+    SteadyStateCheck(const char* what, uint32_t& passes) : what(what), passes(passes), start(threadAllocations) {}
+
+    ~SteadyStateCheck()
+    {
+#ifdef SNAKE_TRACK_ALLOCATIONS
+        uint64_t count = threadAllocations - start;
+        if (passes >= ALLOC_WARMUP && count > 0) {
+            std::cout << "Error: " << count << " heap allocation(s) during steady-state " << what << " " << passes << std::endl;
+            exit(1);
+        }
+#endif
+        passes++;
+    }
+
+private:
+    const char* what;
+    uint32_t& passes;
+    uint64_t start;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+// Per-game bump allocator. One block is allocated up front and carved into
+// the game's fixed-size buffers; starting a new game resets the bump
+// pointer instead of freeing anything. Only trivially destructible types
+// may live here, since nothing is ever destroyed individually.
+
+#include <bits/stdc++.h>
+
+class Arena {
+public:
+    explicit Arena(size_t capacity) : memory(new unsigned char[capacity]), capacity(capacity) {}
+
+    template <class T>
+    T* allocate(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destroyed");
+        size_t start = (used + alignof(T) - 1) & ~(alignof(T) - 1);
+        if (start + count * sizeof(T) > capacity) {
+            std::cout << "Error: Game arena exhausted (" << capacity << " bytes)" << std::endl;
+            exit(1);
+        }
+        used = start + count * sizeof(T);
+        T* items = reinterpret_cast<T*>(memory.get() + start);
+        std::uninitialized_value_construct_n(items, count);
+        return items;
+    }
+
+    void reset()
+    {
+        used = 0;
+    }
+
+    size_t bytesUsed() const
+    {
+        return used;
+    }
+
+private:
+    std::unique_ptr<unsigned char[]> memory;
+    size_t capacity;
+    size_t used = 0;
+};
+
+// Fixed-capacity double-ended ring over arena memory; index 0 is the front.
+// Pushing onto a full ring drops the back element.
+template <class T>
+class FixedRing {
+public:
+    FixedRing(Arena& arena, size_t capacity) : items(arena.allocate<T>(capacity)), capacity(capacity) {}
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    T& operator[](size_t i)
+    {
+        return items[(head + i) % capacity];
+    }
+
+    const T& operator[](size_t i) const
+    {
+        return items[(head + i) % capacity];
+    }
+
+    void pushFront(const T& value)
+    {
+        if (count == capacity) {
+            popBack();
+        }
+        head = (head + capacity - 1) % capacity;
+        items[head] = value;
+        count++;
+    }
+
+    void popBack()
+    {
+        if (count > 0) {
+            count--;
+        }
+    }
+
+    const T& back() const
+    {
+        return (*this)[count - 1];
+    }
+
+private:
+    T* items;
+    size_t capacity;
+    size_t head = 0;
+    size_t count = 0;
+};
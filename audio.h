@@ -0,0 +1,210 @@
+#pragma once
+
+// Audio that never holds up the game. start() opens the mixer and loads
+// the sounds on a background thread, so the first frame does not wait on
+// a slow (or missing) audio device. Sounds played before the device is
+// ready are queued and played once it is, unless they have gone stale;
+// if the device cannot be opened the game simply runs silent.
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <bits/stdc++.h>
+#include "resources.h"
+
+enum SoundId {
+    SOUND_EATING = 0,
+    SOUND_BONUS,
+    SOUND_GAME_OVER,
+    SOUND_COUNT,
+};
+
+enum AudioState {
+    AUDIO_OFF = 0, // start() not called yet
+    AUDIO_PENDING,
+    AUDIO_READY,
+    AUDIO_SILENT,
+};
+
+const char* const SOUND_FILES[SOUND_COUNT] = {"sound/eating.wav", "sound/bonus.wav", "sound/gameover.wav"};
+const char* const MUSIC_FILE = "sound/intro.mp3";
+const int AUDIO_QUEUE_SIZE = 16;
+const int AUDIO_QUEUE_MAX_AGE_MS = 300;
+
+class AudioSystem {
+public:
+    ~AudioSystem()
+    {
+        shutdown();
+    }
+
+    // Starts opening the device in the background; later calls do nothing.
+    void start()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (state != AUDIO_OFF) {
+            return;
+        }
+        state = AUDIO_PENDING;
+        startedAt = std::chrono::steady_clock::now();
+        loader = std::thread([this] { open(); });
+    }
+
+    // Runs without sound; playback calls become no-ops.
+    void startSilent()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (state == AUDIO_OFF) {
+            state = AUDIO_SILENT;
+            std::cout << "Audio disabled" << std::endl;
+        }
+    }
+
+    AudioState status() const
+    {
+        return state;
+    }
+
+    // Safe to call from any thread.
+    void play(SoundId id)
+    {
+        if (state == AUDIO_READY) {
+            playNow(id);
+            return;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        if (state == AUDIO_READY) {
+            playNow(id);
+        } else if (state == AUDIO_PENDING) {
+            if (queued == AUDIO_QUEUE_SIZE) {
+                std::rotate(queue, queue + 1, queue + AUDIO_QUEUE_SIZE);
+                queued--;
+            }
+            queue[queued++] = {id, SDL_GetTicks()};
+        }
+    }
+
+    void playMusic()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        musicWanted = true;
+        if (state == AUDIO_READY && music) {
+            Mix_PlayMusic(music.get(), -1);
+        }
+    }
+
+    void haltMusic()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        musicWanted = false;
+        if (state == AUDIO_READY) {
+            Mix_HaltMusic();
+        }
+    }
+
+    // Waits for the loader, frees every chunk and the music and closes the
+    // device. Safe to call more than once.
+    void shutdown()
+    {
+        if (loader.joinable()) {
+            loader.join();
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        if (state != AUDIO_READY) {
+            return;
+        }
+        Mix_HaltChannel(-1);
+        Mix_HaltMusic();
+        for (ChunkHandle& chunk : chunks) {
+            chunk.reset();
+        }
+        music.reset();
+        Mix_CloseAudio();
+        Mix_Quit();
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        state = AUDIO_SILENT;
+    }
+
+private:
+    struct QueuedSound {
+        SoundId id;
+        Uint32 requestedAt;
+    };
+
+    std::mutex lock;
+    std::atomic<AudioState> state{AUDIO_OFF};
+    std::thread loader;
+    std::chrono::steady_clock::time_point startedAt;
+    ChunkHandle chunks[SOUND_COUNT];
+    MusicHandle music;
+    bool musicWanted = false;
+    QueuedSound queue[AUDIO_QUEUE_SIZE];
+    int queued = 0;
+
+    void playNow(SoundId id)
+    {
+        if (chunks[id]) {
+            Mix_PlayChannel(-1, chunks[id].get(), 0);
+        }
+    }
+
+    void open()
+    {
+        if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+            goSilent("SDL audio could not initialize! SDL_Error: ", SDL_GetError());
+            return;
+        }
+        if ((Mix_Init(MIX_INIT_MP3) & MIX_INIT_MP3) == 0) {
+            std::cout << "SDL_mixer has no MP3 support, intro music disabled: " << Mix_GetError() << std::endl;
+        }
+        if (Mix_OpenAudio(22050, MIX_DEFAULT_FORMAT, 2, 4096) == -1) {
+            Mix_Quit();
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+            goSilent("SDL_mixer could not open audio! SDL_mixer Error: ", Mix_GetError());
+            return;
+        }
+
+        for (int i = 0; i < SOUND_COUNT; i++) {
+            chunks[i] = ownChunk(Mix_LoadWAV(SOUND_FILES[i]));
+            if (!chunks[i]) {
+                std::cout << "Error loading " << SOUND_FILES[i] << ": " << Mix_GetError() << std::endl;
+            }
+        }
+        music = ownMusic(Mix_LoadMUS(MUSIC_FILE), MUSIC_FILE);
+        if (!music) {
+            std::cout << "Error loading music: " << Mix_GetError() << std::endl;
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        state = AUDIO_READY;
+        Uint32 now = SDL_GetTicks();
+        for (int i = 0; i < queued; i++) {
+            if (now - queue[i].requestedAt <= (Uint32)AUDIO_QUEUE_MAX_AGE_MS) {
+                playNow(queue[i].id);
+            }
+        }
+        queued = 0;
+        if (musicWanted && music) {
+            Mix_PlayMusic(music.get(), -1);
+        }
+        std::cout << "Audio ready after " << elapsedMs() << " ms" << std::endl;
+    }
+
+    void goSilent(const char* what, const char* error)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        std::cout << what << error << " (running silent after " << elapsedMs() << " ms)" << std::endl;
+        state = AUDIO_SILENT;
+        queued = 0;
+    }
+
+    long long elapsedMs() const
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startedAt).count();
+    }
+};
+
+inline AudioSystem& audio()
+{
+    static AudioSystem system;
+    return system;
+}
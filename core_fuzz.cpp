@@ -0,0 +1,364 @@
+#include <bits/stdc++.h>
+#include "snake_core.h"
+#include "core_reference.h"
+#include "replay.h"
+
+using namespace std;
+
+// Differential fuzzer for the game core.
+//   core_fuzz [--layout classic|maze|both] [--seconds N] [--threads N] [--ticks N] [--seed N]
+//   core_fuzz --inputs FILE
+//   core_fuzz --corpus DIR [--games N] [--layout ...] [--ticks N] [--seed N]
+// Every case plays one game on SnakeCore, once with each SnakeBody mode,
+// and on the reference model in core_reference.h side by side, from the
+// same seed and the same input stream, and compares their whole state
+// after every tick. The inputs are made up on the fly by a noisy
+// food-chasing player, so games live long enough to reach bonuses, long
+// bodies and (in the maze) pauses. The first divergence is shrunk to a
+// minimal input stream, which is written to FILE.inputs for --inputs and
+// as a replay of the reference game.
+// --corpus plays N such games and saves each as a replay in DIR, which the
+// games' --bench-replays can re-simulate (the Makefile trains PGO on it).
+
+const int FUZZ_WIDTH = 640;
+const int FUZZ_HEIGHT = 480;
+const int FUZZ_CELL = 20;
+const int FUZZ_BONUS_TICKS = 33;
+
+const CoreRules FUZZ_RULES[] = {
+    {FUZZ_WIDTH, FUZZ_HEIGHT, FUZZ_CELL, 5, FUZZ_BONUS_TICKS, false},
+    {FUZZ_WIDTH, FUZZ_HEIGHT, FUZZ_CELL, 2, FUZZ_BONUS_TICKS, true},
+};
+const ReplayLayout FUZZ_LAYOUTS[] = {LAYOUT_CLASSIC, LAYOUT_MAZE};
+
+const int DIRECTIONS[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+struct FuzzInput {
+    uint8_t direction; // index into DIRECTIONS
+    uint8_t continues;
+};
+
+struct FuzzCase {
+    int layout;
+    uint64_t seed;
+    vector<FuzzInput> inputs;
+};
+
+// First difference between the two games, or an empty string.
+string compareGames(const SnakeCore& core, const ReferenceGame& ref)
+{
+    ostringstream out;
+    if (core.over() != ref.over || core.isPaused() != ref.paused || core.moved() != ref.moved) {
+        out << "over/paused/moved " << core.over() << core.isPaused() << core.moved() << " vs " << ref.over << ref.paused << ref.moved;
+    } else if (core.score() != ref.score) {
+        out << "score " << core.score() << " vs " << ref.score;
+    } else if (core.body().size() != ref.snake.size()) {
+        out << "length " << core.body().size() << " vs " << ref.snake.size();
+    } else if (core.food().x != ref.food.x || core.food().y != ref.food.y) {
+        out << "food " << core.food().x << "," << core.food().y << " vs " << ref.food.x << "," << ref.food.y;
+    } else if (core.bonusActive() != ref.bonusActive ||
+               (ref.bonusActive && (core.bonus().x != ref.bonus.x || core.bonus().y != ref.bonus.y))) {
+        out << "bonus " << core.bonusActive() << " " << core.bonus().x << "," << core.bonus().y << " vs " << ref.bonusActive
+            << " " << ref.bonus.x << "," << ref.bonus.y;
+    } else if (core.eventCount() != (int)ref.events.size() || !equal(ref.events.begin(), ref.events.end(), core.events())) {
+        out << core.eventCount() << " events vs " << ref.events.size();
+    } else if (core.rng().state != ref.random.state) {
+        out << "random state";
+    } else {
+        size_t i = 0;
+        int cols = FUZZ_WIDTH / FUZZ_CELL;
+        core.body().forEachCell([&](uint32_t cell) {
+            int x = (int)(cell % cols) * FUZZ_CELL, y = (int)(cell / cols) * FUZZ_CELL;
+            if (out.tellp() == 0 && (x != ref.snake[i].x || y != ref.snake[i].y)) {
+                out << "segment " << i << " " << x << "," << y << " vs " << ref.snake[i].x << "," << ref.snake[i].y;
+            }
+            i++;
+        });
+    }
+    return out.str();
+}
+
+// Heads for the bonus or the food, avoiding walls and its own body, with
+// the odd random turn; pauses in the maze are continued after a short wait.
+FuzzInput choose(const ReferenceGame& ref, int last, mt19937_64& rng)
+{
+    FuzzInput input = {(uint8_t)last, 0};
+    if (ref.paused) {
+        input.continues = rng() % 4 == 0;
+        return input;
+    }
+
+    Segment target = ref.bonusActive ? ref.bonus : ref.food;
+    bool wander = rng() % 8 == 0;
+    int best = INT_MAX;
+    for (int d = 0; d < 4; d++) {
+        Segment next = {ref.snake[0].x + DIRECTIONS[d][0] * FUZZ_CELL, ref.snake[0].y + DIRECTIONS[d][1] * FUZZ_CELL};
+        bool blocked = next.x < FUZZ_CELL || next.x >= FUZZ_WIDTH - FUZZ_CELL || next.y < FUZZ_CELL || next.y >= FUZZ_HEIGHT - FUZZ_CELL;
+        for (size_t i = 1; i + 1 < ref.snake.size() && !blocked; i++) {
+            blocked = ref.snake[i].x == next.x && ref.snake[i].y == next.y;
+        }
+        int distance = wander ? 0 : abs(next.x - target.x) + abs(next.y - target.y);
+        int cost = distance + (blocked ? 100000 : 0) + (int)(rng() % 30);
+        if (cost < best) {
+            best = cost;
+            input.direction = d;
+        }
+    }
+    return input;
+}
+
+// Plays the inputs on both games; returns the tick of the first divergence
+// (and what differed), or -1. With generate set, the inputs are chosen
+// while playing, up to maxTicks.
+int runCase(Arena& arena, FuzzCase& c, bool generate, size_t maxTicks, string* difference, uint64_t* ticks)
+{
+    arena.reset();
+    SnakeCore core(arena, FUZZ_RULES[c.layout], c.seed);
+    SnakeCore packed(arena, FUZZ_RULES[c.layout], c.seed, BODY_STEPS);
+    ReferenceGame ref(FUZZ_RULES[c.layout], c.seed);
+    mt19937_64 rng(c.seed);
+    int last = 0;
+
+    for (size_t t = 0; generate ? t < maxTicks : t < c.inputs.size(); t++) {
+        if (generate) {
+            c.inputs.push_back(choose(ref, last, rng));
+        }
+        const FuzzInput& in = c.inputs[t];
+        last = in.direction;
+        int dx = DIRECTIONS[in.direction][0] * FUZZ_CELL, dy = DIRECTIONS[in.direction][1] * FUZZ_CELL;
+        core.tick(dx, dy, in.continues);
+        packed.tick(dx, dy, in.continues);
+        ref.tick(dx, dy, in.continues);
+        if (ticks) {
+            ++*ticks;
+        }
+
+        string diff = compareGames(core, ref);
+        if (diff.empty()) {
+            diff = compareGames(packed, ref);
+            diff = diff.empty() ? diff : "step-mode body: " + diff;
+        }
+        if (!diff.empty()) {
+            if (difference) {
+                *difference = diff;
+            }
+            return (int)t;
+        }
+        if (ref.over) {
+            break;
+        }
+    }
+    return -1;
+}
+
+// Delta debugging over the input stream: drop chunks, then simplify single
+// inputs, keeping every change that still diverges.
+void shrink(Arena& arena, FuzzCase& c)
+{
+    auto diverges = [&](FuzzCase& trial) {
+        int at = runCase(arena, trial, false, 0, nullptr, nullptr);
+        if (at >= 0) {
+            trial.inputs.resize(at + 1);
+        }
+        return at >= 0;
+    };
+    diverges(c);
+
+    for (size_t chunk = c.inputs.size() / 2; chunk >= 1; chunk /= 2) {
+        for (size_t start = 0; start + chunk <= c.inputs.size();) {
+            FuzzCase trial = c;
+            trial.inputs.erase(trial.inputs.begin() + start, trial.inputs.begin() + start + chunk);
+            if (diverges(trial)) {
+                c = trial;
+            } else {
+                start += chunk;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < c.inputs.size(); i++) {
+        FuzzInput simpler[2] = {{c.inputs[i].direction, 0}, {i > 0 ? c.inputs[i - 1].direction : (uint8_t)0, c.inputs[i].continues}};
+        for (const FuzzInput& s : simpler) {
+            FuzzCase trial = c;
+            trial.inputs[i] = s;
+            if (diverges(trial)) {
+                c = trial;
+                if (i >= c.inputs.size()) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void saveCase(const FuzzCase& c, const string& path)
+{
+    ofstream file(path);
+    file << c.layout << " " << c.seed << "\n";
+    for (const FuzzInput& in : c.inputs) {
+        file << (int)in.direction << " " << (int)in.continues << "\n";
+    }
+}
+
+bool loadCase(FuzzCase& c, const string& path)
+{
+    ifstream file(path);
+    if (!(file >> c.layout >> c.seed) || c.layout < 0 || c.layout > 1) {
+        cout << "Error: Could not read " << path << endl;
+        return false;
+    }
+    int direction, continues;
+    while (file >> direction >> continues) {
+        c.inputs.push_back({(uint8_t)(direction & 3), (uint8_t)continues});
+    }
+    return true;
+}
+
+// Records the reference game's run of the inputs as a normal replay.
+string saveReplay(const FuzzCase& c, const string& dir = REPLAY_DIR)
+{
+    const CoreRules& rules = FUZZ_RULES[c.layout];
+    ReferenceGame ref(rules, c.seed);
+    vector<ReplayFrame> frames(c.inputs.size() + 1);
+    ReplayRecorder recorder;
+    recorder.begin(FUZZ_LAYOUTS[c.layout], rules.screenWidth, rules.screenHeight, rules.cellSize, 120, c.seed, frames.data(),
+                   frames.size());
+    recorder.record(ref.snake, ref.food, ref.bonus, ref.bonusActive, ref.score);
+    for (const FuzzInput& in : c.inputs) {
+        const int* d = DIRECTIONS[in.direction];
+        ref.tick(d[0] * FUZZ_CELL, d[1] * FUZZ_CELL, in.continues);
+        recorder.record(ref.snake, ref.food, ref.bonus, ref.bonusActive, ref.score, replayInput((d[0] + 1) * 3 + d[1] + 1, in.continues));
+    }
+    return recorder.save(dir);
+}
+
+void report(Arena& arena, FuzzCase& c)
+{
+    string diff;
+    int at = runCase(arena, c, false, 0, &diff, nullptr);
+    cout << (c.layout ? "maze" : "classic") << " seed " << c.seed << ": diverges at tick " << at << " of " << c.inputs.size()
+         << ": " << diff << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    vector<int> layouts = {0, 1};
+    double seconds = 60;
+    int threads = max(1u, thread::hardware_concurrency());
+    size_t maxTicks = 5000;
+    uint64_t firstSeed = (uint64_t)time(nullptr) << 20;
+    string inputsPath, corpusDir;
+    int corpusGames = 200;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cout << "Missing value for " << arg << endl;
+            return 1;
+        } else if (arg == "--layout") {
+            string layout = argv[++i];
+            layouts = layout == "classic" ? vector<int>{0} : layout == "maze" ? vector<int>{1} : vector<int>{0, 1};
+        } else if (arg == "--seconds") {
+            seconds = atof(argv[++i]);
+        } else if (arg == "--threads") {
+            threads = max(1, atoi(argv[++i]));
+        } else if (arg == "--ticks") {
+            maxTicks = max(1, atoi(argv[++i]));
+        } else if (arg == "--seed") {
+            firstSeed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--inputs") {
+            inputsPath = argv[++i];
+        } else if (arg == "--corpus") {
+            corpusDir = argv[++i];
+        } else if (arg == "--games") {
+            corpusGames = max(1, atoi(argv[++i]));
+        } else {
+            cout << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    size_t arenaBytes = SnakeCore::bytesFor(FUZZ_RULES[1]) + SnakeCore::bytesFor(FUZZ_RULES[1], BODY_STEPS) + 256;
+    if (!inputsPath.empty()) {
+        Arena arena(arenaBytes);
+        FuzzCase c;
+        if (!loadCase(c, inputsPath)) {
+            return 1;
+        }
+        if (runCase(arena, c, false, 0, nullptr, nullptr) < 0) {
+            cout << "No divergence in " << c.inputs.size() << " ticks" << endl;
+            return 0;
+        }
+        report(arena, c);
+        return 1;
+    }
+
+    if (!corpusDir.empty()) {
+        Arena arena(arenaBytes);
+        uint64_t ticks = 0;
+        for (int n = 0; n < corpusGames; n++) {
+            FuzzCase c;
+            c.layout = layouts[n % layouts.size()];
+            c.seed = firstSeed + n;
+            if (runCase(arena, c, true, maxTicks, nullptr, &ticks) >= 0) {
+                report(arena, c);
+                return 1;
+            }
+            if (saveReplay(c, corpusDir).empty()) {
+                return 1;
+            }
+        }
+        cout << "Wrote " << corpusGames << " games, " << ticks << " ticks to " << corpusDir << endl;
+        return 0;
+    }
+
+    cout << "Fuzzing from seed " << firstSeed << " on " << threads << " threads for " << seconds << " s" << endl;
+    atomic<uint64_t> nextCase{0};
+    atomic<uint64_t> totalTicks{0};
+    atomic<bool> failed{false};
+    mutex failureLock;
+    FuzzCase failure;
+    auto deadline = chrono::steady_clock::now() + chrono::duration<double>(seconds);
+    auto start = chrono::steady_clock::now();
+
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&] {
+            Arena arena(arenaBytes);
+            uint64_t ticks = 0;
+            while (!failed && chrono::steady_clock::now() < deadline) {
+                uint64_t n = nextCase++;
+                FuzzCase c;
+                c.layout = layouts[n % layouts.size()];
+                c.seed = firstSeed + n;
+                if (runCase(arena, c, true, maxTicks, nullptr, &ticks) >= 0) {
+                    lock_guard<mutex> guard(failureLock);
+                    if (!failed) {
+                        failed = true;
+                        failure = c;
+                    }
+                }
+            }
+            totalTicks += ticks;
+        });
+    }
+    for (thread& t : workers) {
+        t.join();
+    }
+
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << fixed << setprecision(0) << nextCase << " games, " << totalTicks << " ticks in " << setprecision(1) << elapsed
+         << " s: " << setprecision(0) << totalTicks / elapsed * 60 << " ticks/min" << endl;
+    if (!failed) {
+        cout << "No divergence" << endl;
+        return 0;
+    }
+
+    Arena arena(arenaBytes);
+    report(arena, failure);
+    shrink(arena, failure);
+    report(arena, failure);
+    string path = "core_fuzz-" + to_string(failure.seed) + ".inputs";
+    saveCase(failure, path);
+    cout << "Inputs: " << path << ", replay: " << saveReplay(failure) << endl;
+    return 1;
+}
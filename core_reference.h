@@ -0,0 +1,165 @@
+#pragma once
+
+// The game rules written the plain way, as they were before the game core
+// was optimized: a vector body with a linear self-collision scan, food and
+// bonus as single positions with the original collision tests, walls as a
+// list of rectangles and a countdown for the bonus. core_fuzz runs it in
+// lockstep with SnakeCore; any difference between the two is a bug in the
+// faster one, so keep this one simple rather than fast.
+
+#include "snake_core.h"
+
+class ReferenceGame {
+public:
+    std::vector<Segment> snake; // head first
+    Segment food = {0, 0};
+    Segment bonus = {0, 0};
+    bool bonusActive = false;
+    int bonusTicksLeft = 0;
+    int foodCounter = 0;
+    int score = 0;
+    bool paused = false;
+    bool over = false;
+    bool moved = false;
+    std::vector<CoreEvent> events;
+    CoreRandom random;
+
+    ReferenceGame(const CoreRules& rules, uint64_t seed) : rules(rules)
+    {
+        random.state = seed;
+        Segment corners[8], sizes[8];
+        int walls = coreWalls(rules, corners, sizes);
+        wallCorners.assign(corners, corners + walls);
+        wallSizes.assign(sizes, sizes + walls);
+        snake.push_back({rules.screenWidth / 2, rules.screenHeight / 2});
+        foodPresent = false;
+        food = khabarToiriKor();
+        foodPresent = true;
+    }
+
+    void tick(int dx, int dy, int continues)
+    {
+        events.clear();
+        moved = false;
+        for (int i = 0; i < continues; i++) {
+            if (paused) {
+                events.push_back({EVENT_CONTINUE, CAUSE_NONE, 0, 0, score - CORE_CONTINUE_COST, 0});
+            }
+            paused = false;
+            score -= CORE_CONTINUE_COST;
+        }
+        if (over || paused) {
+            return;
+        }
+        moved = true;
+
+        if (bonusActive && --bonusTicksLeft == 0) {
+            events.push_back({EVENT_BONUS_EXPIRE, CAUSE_NONE, bonus.x, bonus.y, score, (int)snake.size()});
+            bonusActive = false;
+            if (rules.maze) {
+                foodCounter = 0;
+                spawnBonus();
+            }
+        }
+        uint16_t deathCause = CAUSE_NONE;
+
+        Segment newHead = {snake[0].x + dx, snake[0].y + dy};
+        snake.insert(snake.begin(), newHead);
+
+        bool foodEaten = false;
+        if (checkCollision(snake[0], food)) {
+            foodEaten = true;
+            foodPresent = false;
+            score += CORE_FOOD_VALUE;
+            foodCounter++;
+            events.push_back({EVENT_FOOD_EATEN, CAUSE_NONE, food.x, food.y, score, (int)snake.size()});
+            if (!bonusActive && foodCounter % rules.bonusEvery == 0) {
+                foodCounter = 0;
+                spawnBonus();
+            }
+        } else if (bonusActive && checkBonusCollision(snake[0], bonus)) {
+            score += CORE_BONUS_VALUE;
+            bonusActive = false;
+            events.push_back({EVENT_BONUS_EATEN, CAUSE_NONE, bonus.x, bonus.y, score, (int)snake.size()});
+        } else {
+            snake.pop_back();
+        }
+
+        for (size_t i = 1; i < snake.size(); i++) {
+            if (checkCollision(snake[0], snake[i])) {
+                over = true;
+                deathCause = CAUSE_SELF;
+                foodCounter = 0;
+            }
+        }
+
+        int c = rules.cellSize;
+        if (snake[0].x < c || snake[0].x >= rules.screenWidth - c || snake[0].y < c || snake[0].y >= rules.screenHeight - c) {
+            foodCounter = 0;
+            over = true;
+            deathCause = CAUSE_BORDER_WALL;
+        }
+
+        if (rules.maze && (snake[0].x < 100 || snake[0].x >= 600 || snake[0].y < c || snake[0].y >= rules.screenHeight - c)) {
+            paused = true;
+            if (deathCause == CAUSE_NONE) {
+                deathCause = CAUSE_MAZE_WALL;
+            }
+        }
+
+        if (deathCause != CAUSE_NONE) {
+            events.push_back({EVENT_DEATH, deathCause, snake[0].x, snake[0].y, score, (int)snake.size()});
+        }
+
+        if (foodEaten) {
+            food = khabarToiriKor();
+            foodPresent = true;
+        }
+    }
+
+private:
+    CoreRules rules;
+    std::vector<Segment> wallCorners, wallSizes;
+    bool foodPresent = false;
+
+    static bool checkCollision(const Segment& a, const Segment& b)
+    {
+        return a.x == b.x && a.y == b.y;
+    }
+
+    bool checkBonusCollision(const Segment& a, const Segment& b) const
+    {
+        return abs(a.x - b.x) < rules.cellSize && abs(a.y - b.y) < rules.cellSize;
+    }
+
+    bool taken(const Segment& s) const
+    {
+        for (size_t i = 0; i < wallCorners.size(); i++) {
+            if (s.x >= wallCorners[i].x && s.x < wallCorners[i].x + wallSizes[i].x && s.y >= wallCorners[i].y &&
+                s.y < wallCorners[i].y + wallSizes[i].y) {
+                return true;
+            }
+        }
+        return (foodPresent && checkCollision(s, food)) || (bonusActive && checkCollision(s, bonus));
+    }
+
+    // Random cells until one is free of walls, food and the bonus.
+    Segment khabarToiriKor()
+    {
+        int c = rules.cellSize;
+        Segment s;
+        do {
+            s.x = random.next() % ((rules.screenWidth - 4 * c) / c) * c + c;
+            s.y = random.next() % ((rules.screenHeight - 4 * c) / c) * c + c;
+        } while (taken(s));
+        return s;
+    }
+
+    void spawnBonus()
+    {
+        bonus = khabarToiriKor();
+        bonusActive = true;
+        bonusTicksLeft = rules.bonusTicks;
+        events.push_back({EVENT_BONUS_SPAWN, CAUSE_NONE, bonus.x, bonus.y, score, (int)snake.size()});
+    }
+};
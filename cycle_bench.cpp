@@ -0,0 +1,96 @@
+#include <bits/stdc++.h>
+#include "hamiltonian.h"
+
+using namespace std;
+
+// Hamiltonian cycle construction and the autopilot that follows it.
+//   cycle_bench [--side N] [--threads N] [--games N]
+// Builds the cycle of an N x N board (1024 x 1024 inside the border by
+// default, one pixel a cell) on one thread and on all of them, times a
+// round trip through the cycle cache (in build/cycles), then plays N
+// classic games on the autopilot and counts how many fill the board.
+
+int main(int argc, char* argv[])
+{
+    int side = 1024, games = 10;
+    int threads = max(1u, thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cout << "Missing value for " << arg << endl;
+            return 1;
+        } else if (arg == "--side") {
+            side = max(2, atoi(argv[++i]) / 2 * 2);
+        } else if (arg == "--threads") {
+            threads = max(1, atoi(argv[++i]));
+        } else if (arg == "--games") {
+            games = max(0, atoi(argv[++i]));
+        } else {
+            cout << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    CoreRules board = {side + 2, side + 2, 1, 5, 33, false};
+    vector<uint8_t> free = cycleMask(board);
+    HamiltonianCycle cycle;
+    for (int t : {1, threads}) {
+        auto start = chrono::steady_clock::now();
+        cycle = buildCycle(side + 2, side + 2, free, t);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << side << "x" << side << " cycle of " << cycle.size() << " cells on " << t << " thread" << (t > 1 ? "s" : "") << ": "
+             << fixed << setprecision(1) << ms << " ms" << endl;
+    }
+    if (cycle.empty()) {
+        cout << "Error: No cycle built" << endl;
+        return 1;
+    }
+
+    uint32_t maskCrc = crc32(free.data(), free.size());
+    string path = cycleFileFor(side + 2, side + 2, maskCrc, "build/cycles");
+    auto start = chrono::steady_clock::now();
+    if (!saveCycle(path, cycle, maskCrc)) {
+        return 1;
+    }
+    double saveMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    start = chrono::steady_clock::now();
+    HamiltonianCycle loaded;
+    bool found;
+    if (!loadCycle(path, side + 2, side + 2, free, maskCrc, threads, loaded, found) || loaded.order != cycle.order) {
+        cout << "Error: Cycle cache " << path << " did not read back" << endl;
+        return 1;
+    }
+    double loadMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "Cache: " << saveMs << " ms to write, " << loadMs << " ms to read back" << endl;
+
+    // main's rules.
+    CoreRules rules = {640, 480, 20, 5, 4000 / 120, false};
+    int cols = rules.screenWidth / rules.cellSize, c = rules.cellSize;
+    HamiltonianCycle boardCycle = buildCycle(cols, rules.screenHeight / c, cycleMask(rules), threads);
+    CycleAutopilot autopilot(boardCycle);
+    int filled = 0;
+    uint64_t ticks = 0;
+    for (int g = 0; g < games; g++) {
+        Arena arena(SnakeCore::bytesFor(rules) + 256);
+        SnakeCore core(arena, rules, g + 1);
+        size_t longest = 0;
+        while (!core.over()) {
+            uint32_t targets[2];
+            int count = 0;
+            targets[count++] = core.food().y / c * cols + core.food().x / c;
+            if (core.bonusActive()) {
+                targets[count++] = core.bonus().y / c * cols + core.bonus().x / c;
+            }
+            uint32_t head = core.body().cellAt(0);
+            uint32_t next = autopilot.nextCell(core.body(), targets, count);
+            core.tick(((int)(next % cols) - (int)(head % cols)) * c, ((int)(next / cols) - (int)(head / cols)) * c, 0);
+            longest = max(longest, core.body().size());
+            ticks++;
+        }
+        filled += longest >= boardCycle.size();
+    }
+    if (games > 0) {
+        cout << "Autopilot filled the board in " << filled << " of " << games << " games, " << ticks / games << " ticks a game" << endl;
+    }
+    return filled == games ? 0 : 1;
+}
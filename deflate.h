@@ -0,0 +1,267 @@
+#pragma once
+
+// Deflate with the fixed Huffman code only, in zlib framing. encodePng
+// drives DeflateBits directly with its own run search; zlibCompress is the
+// general version (greedy LZ77 over a 32 KB window, one hash candidate per
+// position) for small text payloads such as score sync batches, and
+// zlibInflate reads back what either of them wrote (stored and fixed
+// blocks; dynamic Huffman blocks are refused).
+
+#include <bits/stdc++.h>
+
+class DeflateBits {
+public:
+    std::vector<uint8_t>& out;
+    uint32_t buffer = 0;
+    int count = 0;
+
+    explicit DeflateBits(std::vector<uint8_t>& out) : out(out) {}
+
+    void put(uint32_t bits, int n)
+    {
+        buffer |= bits << count;
+        count += n;
+        while (count >= 8) {
+            out.push_back((uint8_t)buffer);
+            buffer >>= 8;
+            count -= 8;
+        }
+    }
+
+    // Huffman codes go in most significant bit first.
+    void putCode(uint32_t code, int n)
+    {
+        uint32_t reversed = 0;
+        for (int i = 0; i < n; i++) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        put(reversed, n);
+    }
+
+    void flush()
+    {
+        if (count > 0) {
+            out.push_back((uint8_t)buffer);
+        }
+        buffer = 0;
+        count = 0;
+    }
+
+    void literal(int value)
+    {
+        if (value < 144) putCode(0x30 + value, 8);
+        else if (value < 256) putCode(0x190 + value - 144, 9);
+        else if (value < 280) putCode(value - 256, 7);
+        else putCode(0xC0 + value - 280, 8);
+    }
+
+    // A back-reference of 3..258 bytes at distance 1..32768.
+    void match(int length, int distance)
+    {
+        int code = 28;
+        while (lengthBase[code] > length) {
+            code--;
+        }
+        literal(257 + code);
+        put(length - lengthBase[code], lengthExtra[code]);
+
+        code = 29;
+        while (distanceBase[code] > distance) {
+            code--;
+        }
+        putCode(code, 5);
+        put(distance - distanceBase[code], distanceExtra[code]);
+    }
+
+    // At distance 3, one RGB pixel back.
+    void match(int length)
+    {
+        match(length, 3);
+    }
+
+    static constexpr int lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+                                           31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static constexpr int lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                            2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static constexpr int distanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                             193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static constexpr int distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                              6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+};
+
+inline uint32_t adler32(const uint8_t* data, size_t size)
+{
+    uint32_t a = 1, b = 0;
+    while (size > 0) {
+        size_t chunk = std::min<size_t>(size, 5552);
+        size -= chunk;
+        for (size_t i = 0; i < chunk; i++) {
+            a += data[i];
+            b += a;
+        }
+        data += chunk;
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+inline void appendBigEndian(std::vector<uint8_t>& out, uint32_t v)
+{
+    out.push_back((uint8_t)(v >> 24));
+    out.push_back((uint8_t)(v >> 16));
+    out.push_back((uint8_t)(v >> 8));
+    out.push_back((uint8_t)v);
+}
+
+inline void zlibCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+{
+    const int hashBits = 12;
+    const size_t window = 32768;
+    std::vector<int64_t> last(1 << hashBits, -1); // latest position of each 3-byte prefix
+    auto hashAt = [&](size_t p) {
+        return (uint32_t)(data[p] << 16 | data[p + 1] << 8 | data[p + 2]) * 2654435761u >> (32 - hashBits);
+    };
+
+    out.clear();
+    out.push_back(0x78);
+    out.push_back(0x01);
+    DeflateBits bits(out);
+    bits.put(1, 1); // final block
+    bits.put(1, 2); // fixed Huffman
+    size_t i = 0;
+    while (i < size) {
+        size_t length = 0, distance = 0;
+        if (i + 3 <= size) {
+            uint32_t h = hashAt(i);
+            int64_t candidate = last[h];
+            last[h] = (int64_t)i;
+            if (candidate >= 0 && i - candidate <= window) {
+                while (length < 258 && i + length < size && data[candidate + length] == data[i + length]) {
+                    length++;
+                }
+                distance = i - candidate;
+            }
+        }
+        if (length >= 3) {
+            bits.match((int)length, (int)distance);
+            for (size_t k = i + 1; k < i + length && k + 3 <= size; k++) {
+                last[hashAt(k)] = (int64_t)k;
+            }
+            i += length;
+        } else {
+            bits.literal(data[i]);
+            i++;
+        }
+    }
+    bits.literal(256);
+    bits.flush();
+    appendBigEndian(out, adler32(data, size));
+}
+
+// False if the stream is damaged, uses dynamic Huffman blocks or would
+// inflate to more than limit bytes.
+inline bool zlibInflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out, size_t limit)
+{
+    out.clear();
+    if (size < 6 || (data[0] & 0x0F) != 8 || (data[0] << 8 | data[1]) % 31 != 0 || (data[1] & 0x20)) {
+        return false;
+    }
+    size_t pos = 2;
+    uint32_t buffer = 0;
+    int count = 0;
+    bool overrun = false;
+    auto bits = [&](int n) {
+        while (count < n) {
+            if (pos >= size) {
+                overrun = true;
+                return 0u;
+            }
+            buffer |= (uint32_t)data[pos++] << count;
+            count += 8;
+        }
+        uint32_t v = buffer & ((1u << n) - 1);
+        buffer >>= n;
+        count -= n;
+        return v;
+    };
+    auto code = [&](int n) {
+        uint32_t c = 0;
+        for (int i = 0; i < n; i++) {
+            c = c << 1 | bits(1);
+        }
+        return c;
+    };
+    // The fixed literal/length code is 7, 8 or 9 bits long.
+    auto literal = [&]() {
+        uint32_t c = code(7);
+        if (c <= 23) {
+            return (int)(256 + c);
+        }
+        c = c << 1 | bits(1);
+        if (c >= 48 && c <= 191) {
+            return (int)(c - 48);
+        }
+        if (c >= 192 && c <= 199) {
+            return (int)(280 + c - 192);
+        }
+        c = c << 1 | bits(1);
+        return c >= 400 && c <= 511 ? (int)(144 + c - 400) : -1;
+    };
+
+    bool final = false;
+    while (!final && !overrun) {
+        final = bits(1);
+        uint32_t type = bits(2);
+        if (type == 0) {
+            buffer = 0;
+            count = 0;
+            if (pos + 4 > size) {
+                return false;
+            }
+            size_t length = data[pos] | data[pos + 1] << 8;
+            if ((length ^ (data[pos + 2] | data[pos + 3] << 8)) != 0xFFFF || pos + 4 + length > size || out.size() + length > limit) {
+                return false;
+            }
+            out.insert(out.end(), data + pos + 4, data + pos + 4 + length);
+            pos += 4 + length;
+        } else if (type == 1) {
+            while (!overrun) {
+                int symbol = literal();
+                if (symbol < 0 || symbol > 285) {
+                    return false;
+                }
+                if (symbol < 256) {
+                    if (out.size() == limit) {
+                        return false;
+                    }
+                    out.push_back((uint8_t)symbol);
+                    continue;
+                }
+                if (symbol == 256) {
+                    break;
+                }
+                symbol -= 257;
+                size_t length = DeflateBits::lengthBase[symbol] + bits(DeflateBits::lengthExtra[symbol]);
+                uint32_t d = code(5);
+                if (d > 29) {
+                    return false;
+                }
+                size_t distance = DeflateBits::distanceBase[d] + bits(DeflateBits::distanceExtra[d]);
+                if (distance > out.size() || out.size() + length > limit) {
+                    return false;
+                }
+                for (size_t k = 0; k < length; k++) {
+                    out.push_back(out[out.size() - distance]);
+                }
+            }
+        } else {
+            return false;
+        }
+    }
+    if (overrun || pos + 4 > size) {
+        return false;
+    }
+    uint32_t stored = (uint32_t)data[pos] << 24 | data[pos + 1] << 16 | data[pos + 2] << 8 | data[pos + 3];
+    return stored == adler32(out.data(), out.size());
+}
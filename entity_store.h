@@ -0,0 +1,186 @@
+#pragma once
+
+// Food, bonuses and walls as a structure of arrays over arena memory. The
+// live entities are packed at the front of each column, so drawing them
+// is a linear walk; removing one moves the last entity into its place.
+// Each board cell holds a back-reference to the entity covering it, so
+// finding what the head landed on is a single lookup. Callers keep stable
+// ids (dense indexes change when something is removed) and convert with
+// indexOf(). Walls cover a rectangle of cells; everything else one cell.
+
+#include "arena.h"
+
+enum EntityType : uint8_t {
+    ENTITY_FOOD = 0,
+    ENTITY_BONUS,
+    ENTITY_WALL,
+};
+
+// The dense columns; also what a snapshot copies for the renderer.
+struct EntityColumns {
+    uint8_t* type = nullptr;
+    uint16_t* cell = nullptr;     // top-left cell, row * cols + col
+    uint8_t* width = nullptr;     // in cells
+    uint8_t* height = nullptr;
+    int32_t* value = nullptr;     // score for consuming it
+    uint32_t* expiresAt = nullptr; // simulation tick, 0 for never
+    int count = 0;
+
+    void allocate(Arena& arena, int capacity)
+    {
+        type = arena.allocate<uint8_t>(capacity);
+        cell = arena.allocate<uint16_t>(capacity);
+        width = arena.allocate<uint8_t>(capacity);
+        height = arena.allocate<uint8_t>(capacity);
+        value = arena.allocate<int32_t>(capacity);
+        expiresAt = arena.allocate<uint32_t>(capacity);
+        count = 0;
+    }
+
+    // Both must have been allocated with the same capacity.
+    void copyFrom(const EntityColumns& other)
+    {
+        count = other.count;
+        std::copy_n(other.type, count, type);
+        std::copy_n(other.cell, count, cell);
+        std::copy_n(other.width, count, width);
+        std::copy_n(other.height, count, height);
+        std::copy_n(other.value, count, value);
+        std::copy_n(other.expiresAt, count, expiresAt);
+    }
+
+    static size_t bytesFor(int capacity)
+    {
+        return (size_t)capacity * (3 * sizeof(uint8_t) + sizeof(uint16_t) + sizeof(int32_t) + sizeof(uint32_t)) + 32;
+    }
+};
+
+class EntityStore {
+public:
+    EntityStore(Arena& arena, int cols, int rows, int cellSize, int capacity)
+        : ids(arena.allocate<int32_t>(capacity)), denseOf(arena.allocate<int32_t>(capacity)),
+          freeIds(arena.allocate<int32_t>(capacity)), grid(arena.allocate<int32_t>((size_t)cols * rows)),
+          cols(cols), rows(rows), cellSize(cellSize), capacity(capacity)
+    {
+        data.allocate(arena, capacity);
+        std::fill_n(grid, (size_t)cols * rows, -1);
+        for (int i = 0; i < capacity; i++) {
+            freeIds[i] = capacity - 1 - i;
+            denseOf[i] = -1;
+        }
+        freeCount = capacity;
+    }
+
+    static size_t bytesFor(int cols, int rows, int capacity)
+    {
+        return EntityColumns::bytesFor(capacity) + (size_t)capacity * 3 * sizeof(int32_t) +
+               (size_t)cols * rows * sizeof(int32_t) + 32;
+    }
+
+    const EntityColumns& columns() const
+    {
+        return data;
+    }
+
+    int size() const
+    {
+        return data.count;
+    }
+
+    // x, y, w and h in pixels, on cell boundaries. Returns the entity's id.
+    int spawn(EntityType type, int x, int y, int w, int h, int value, uint32_t expiresAt = 0)
+    {
+        if (freeCount == 0) {
+            std::cout << "Error: Entity store full (" << capacity << " entities)" << std::endl;
+            exit(1);
+        }
+        int id = freeIds[--freeCount];
+        int i = data.count++;
+        ids[i] = id;
+        denseOf[id] = i;
+        data.type[i] = type;
+        data.cell[i] = (uint16_t)((y / cellSize) * cols + x / cellSize);
+        data.width[i] = (uint8_t)std::max(1, w / cellSize);
+        data.height[i] = (uint8_t)std::max(1, h / cellSize);
+        data.value[i] = value;
+        data.expiresAt[i] = expiresAt;
+        mark(i, -1, i);
+        return id;
+    }
+
+    void remove(int id)
+    {
+        int i = indexOf(id);
+        if (i < 0) {
+            return;
+        }
+        int last = --data.count;
+        mark(i, i, -1);
+        if (i != last) {
+            mark(last, last, i);
+            data.type[i] = data.type[last];
+            data.cell[i] = data.cell[last];
+            data.width[i] = data.width[last];
+            data.height[i] = data.height[last];
+            data.value[i] = data.value[last];
+            data.expiresAt[i] = data.expiresAt[last];
+            ids[i] = ids[last];
+            denseOf[ids[i]] = i;
+        }
+        denseOf[id] = -1;
+        freeIds[freeCount++] = id;
+    }
+
+    // Dense index of a live id, or -1.
+    int indexOf(int id) const
+    {
+        return id >= 0 && id < capacity ? denseOf[id] : -1;
+    }
+
+    int idAt(int i) const
+    {
+        return ids[i];
+    }
+
+    // Dense index of the entity covering the pixel's cell, or -1.
+    int at(int x, int y) const
+    {
+        if (x < 0 || y < 0 || x / cellSize >= cols || y / cellSize >= rows) {
+            return -1;
+        }
+        return grid[(y / cellSize) * cols + x / cellSize];
+    }
+
+    int x(int i) const
+    {
+        return data.cell[i] % cols * cellSize;
+    }
+
+    int y(int i) const
+    {
+        return data.cell[i] / cols * cellSize;
+    }
+
+private:
+    EntityColumns data;
+    int32_t* ids;     // dense index -> id
+    int32_t* denseOf; // id -> dense index, -1 if free
+    int32_t* freeIds;
+    int32_t* grid;    // cell -> dense index of its entity, -1 if empty
+    int freeCount = 0;
+    int cols, rows, cellSize, capacity;
+
+    // Points the cells of entity i that hold `from` at `to`. Where entities
+    // overlap (wall corners) the first one keeps the cell.
+    void mark(int i, int from, int to)
+    {
+        int col = data.cell[i] % cols, row = data.cell[i] / cols;
+        for (int r = row; r < std::min(rows, row + data.height[i]); r++) {
+            for (int c = col; c < std::min(cols, col + data.width[i]); c++) {
+                if (grid[r * cols + c] == from) {
+                    grid[r * cols + c] = to;
+                }
+            }
+        }
+    }
+};
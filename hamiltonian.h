@@ -0,0 +1,599 @@
+#pragma once
+
+// Hamiltonian cycles over a board's free cells, cached on disk per layout,
+// and an autopilot that follows one, so a snake can fill the whole board
+// without ever running into itself.
+//
+// buildCycle tiles the free cells with 2x2 blocks (trying each of the four
+// offsets), joins the blocks with a spanning tree and walks around the
+// tree: every cell's successor depends only on its block's tree edges, so
+// the successors are found on all threads and only the final walk that
+// orders the cells is serial. A region the blocks cannot tile and that is
+// small enough is searched for a cycle directly instead, within a step
+// budget. A cycle needs as many cells of one checkerboard colour as of the
+// other, so a region where they differ (task301's maze) has none and is
+// rejected up front.
+//
+// cachedCycle keys the cycle by board size and a CRC of the free-cell mask
+// and keeps it in cycles/<cols>x<rows>-<crc>.cycle: a CycleFileHeader, then
+// the cells in cycle order as uint32. A layout with no cycle is cached too,
+// with a length of 0, so it is not searched again on every start.
+//
+// CycleAutopilot steps along the cycle, and while the snake is shorter than
+// half the cycle cuts across it towards the food, but only to cells ahead
+// of the head and behind the tail on the cycle: the body always lies along
+// the cycle from tail to head, so those cells are free and stay free until
+// the tail has passed them.
+
+#include <bits/stdc++.h>
+#include "crc32.h"
+#include "mapped_file.h"
+#include "snake_core.h"
+
+const uint32_t CYCLE_MAGIC = 0x43594353; // "SCYC"
+const uint16_t CYCLE_VERSION = 1;
+const char* const CYCLE_DIR = "cycles";
+const uint32_t CYCLE_NONE = UINT32_MAX;
+const size_t CYCLE_SEARCH_CELLS = 4096; // largest region searched when the blocks do not fit
+const uint64_t CYCLE_SEARCH_STEPS = 1000000;
+
+struct CycleFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t cols, rows;
+    uint32_t maskCrc;
+    uint32_t length; // cells; 0 if the layout has no cycle
+    uint32_t crc;    // of the cells
+    uint32_t pad;
+};
+
+struct HamiltonianCycle {
+    int cols = 0, rows = 0;
+    std::vector<uint32_t> order; // cells, in cycle order
+    std::vector<uint32_t> index; // each cell's position in order, CYCLE_NONE if not on the cycle
+
+    bool empty() const
+    {
+        return order.empty();
+    }
+
+    size_t size() const
+    {
+        return order.size();
+    }
+
+    bool contains(uint32_t cell) const
+    {
+        return cell < index.size() && index[cell] != CYCLE_NONE;
+    }
+
+    uint32_t next(uint32_t cell) const
+    {
+        return order[(index[cell] + 1) % order.size()];
+    }
+
+    // Moves along the cycle from one cell to the other; both must be on it.
+    size_t distance(uint32_t from, uint32_t to) const
+    {
+        return (index[to] + order.size() - index[from]) % order.size();
+    }
+};
+
+// Calls f(begin, end) over [0, n) split across threads.
+template <class F>
+void cycleParallel(int n, int threads, F f)
+{
+    threads = std::max(1, std::min(threads, n));
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; t++) {
+        workers.emplace_back(f, (int)((int64_t)n * t / threads), (int)((int64_t)n * (t + 1) / threads));
+    }
+    f(0, n / threads);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// The cells a game's snake can use: inside the border, off the walls and,
+// in the maze, inside the middle it pauses on leaving.
+inline std::vector<uint8_t> cycleMask(const CoreRules& rules)
+{
+    int c = rules.cellSize;
+    int cols = rules.screenWidth / c, rows = rules.screenHeight / c;
+    std::vector<uint8_t> free((size_t)cols * rows, 0);
+    for (int y = 1; y < rows - 1; y++) {
+        for (int x = 1; x < cols - 1; x++) {
+            free[(size_t)y * cols + x] = !rules.maze || (x * c >= 100 && x * c < 600);
+        }
+    }
+    Segment corners[8], sizes[8];
+    int walls = coreWalls(rules, corners, sizes);
+    for (int w = 0; w < walls; w++) {
+        for (int y = corners[w].y / c; y < (corners[w].y + sizes[w].y) / c; y++) {
+            for (int x = corners[w].x / c; x < (corners[w].x + sizes[w].x) / c; x++) {
+                free[(size_t)y * cols + x] = 0;
+            }
+        }
+    }
+    return free;
+}
+
+// Fills cycle.index from cycle.order; false if order is not a cycle over
+// exactly the free cells.
+inline bool indexCycle(HamiltonianCycle& cycle, const std::vector<uint8_t>& free, int threads)
+{
+    size_t n = cycle.order.size();
+    cycle.index.assign(free.size(), CYCLE_NONE);
+    std::atomic<bool> valid{true};
+    cycleParallel((int)std::min(n, (size_t)INT_MAX), threads, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            uint32_t a = cycle.order[i], b = cycle.order[(i + 1) % n];
+            if (a >= free.size() || b >= free.size() || !free[a]) {
+                valid = false;
+                return;
+            }
+            int dx = std::abs((int)(a % cycle.cols) - (int)(b % cycle.cols));
+            int dy = std::abs((int)(a / cycle.cols) - (int)(b / cycle.cols));
+            if (dx + dy != 1) {
+                valid = false;
+                return;
+            }
+            cycle.index[a] = (uint32_t)i;
+        }
+    });
+    // Every free cell must have been given a position exactly once.
+    size_t placed = 0;
+    for (size_t cell = 0; cell < free.size() && valid; cell++) {
+        if (cycle.index[cell] != CYCLE_NONE && cycle.order[cycle.index[cell]] == cell) {
+            placed++;
+        } else if (free[cell]) {
+            return false;
+        }
+    }
+    return valid && placed == n;
+}
+
+// The blocks way round: false if the free cells are not a connected union
+// of 2x2 blocks at offset (ox, oy).
+inline bool blockCycle(HamiltonianCycle& cycle, const std::vector<uint8_t>& free, size_t freeCells, int ox, int oy, int threads)
+{
+    int cols = cycle.cols, rows = cycle.rows;
+    int bc = (cols - ox) / 2, br = (rows - oy) / 2;
+    if (bc <= 0 || br <= 0) {
+        return false;
+    }
+    auto cellOf = [&](int bx, int by, int dx, int dy) {
+        return (uint32_t)((size_t)(by * 2 + oy + dy) * cols + bx * 2 + ox + dx);
+    };
+
+    std::vector<uint8_t> full((size_t)bc * br);
+    std::atomic<size_t> fullBlocks{0};
+    cycleParallel(br, threads, [&](int begin, int end) {
+        size_t count = 0;
+        for (int by = begin; by < end; by++) {
+            for (int bx = 0; bx < bc; bx++) {
+                bool all = free[cellOf(bx, by, 0, 0)] && free[cellOf(bx, by, 1, 0)] && free[cellOf(bx, by, 0, 1)] && free[cellOf(bx, by, 1, 1)];
+                full[(size_t)by * bc + bx] = all;
+                count += all;
+            }
+        }
+        fullBlocks += count;
+    });
+    if (fullBlocks * 4 != freeCells) {
+        return false;
+    }
+
+    // A spanning tree over the blocks, breadth first; links holds each
+    // block's tree edges.
+    enum { LINK_RIGHT = 1, LINK_DOWN = 2, LINK_LEFT = 4, LINK_UP = 8 };
+    std::vector<uint8_t> links((size_t)bc * br, 0);
+    std::vector<uint8_t> seen((size_t)bc * br, 0);
+    std::vector<uint32_t> queue;
+    queue.reserve(fullBlocks);
+    uint32_t root = (uint32_t)(std::find(full.begin(), full.end(), 1) - full.begin());
+    queue.push_back(root);
+    seen[root] = 1;
+    const int steps[4][3] = {{1, 0, LINK_RIGHT}, {0, 1, LINK_DOWN}, {-1, 0, LINK_LEFT}, {0, -1, LINK_UP}};
+    for (size_t q = 0; q < queue.size(); q++) {
+        int bx = queue[q] % bc, by = queue[q] / bc;
+        for (const int* s : steps) {
+            int nx = bx + s[0], ny = by + s[1];
+            uint32_t nb = (uint32_t)(ny * bc + nx);
+            if (nx < 0 || ny < 0 || nx >= bc || ny >= br || !full[nb] || seen[nb]) {
+                continue;
+            }
+            seen[nb] = 1;
+            links[queue[q]] |= s[2];
+            links[nb] |= s[2] < LINK_LEFT ? s[2] << 2 : s[2] >> 2;
+            queue.push_back(nb);
+        }
+    }
+    if (queue.size() != fullBlocks) {
+        return false;
+    }
+
+    // Round each block anticlockwise, crossing into a neighbour wherever
+    // the tree joins them.
+    std::vector<uint32_t> successor(free.size(), CYCLE_NONE);
+    cycleParallel(br, threads, [&](int begin, int end) {
+        for (int by = begin; by < end; by++) {
+            for (int bx = 0; bx < bc; bx++) {
+                uint8_t l = links[(size_t)by * bc + bx];
+                if (!full[(size_t)by * bc + bx]) {
+                    continue;
+                }
+                successor[cellOf(bx, by, 0, 0)] = l & LINK_LEFT ? cellOf(bx - 1, by, 1, 0) : cellOf(bx, by, 0, 1);
+                successor[cellOf(bx, by, 0, 1)] = l & LINK_DOWN ? cellOf(bx, by + 1, 0, 0) : cellOf(bx, by, 1, 1);
+                successor[cellOf(bx, by, 1, 1)] = l & LINK_RIGHT ? cellOf(bx + 1, by, 0, 1) : cellOf(bx, by, 1, 0);
+                successor[cellOf(bx, by, 1, 0)] = l & LINK_UP ? cellOf(bx, by - 1, 1, 1) : cellOf(bx, by, 0, 0);
+            }
+        }
+    });
+
+    uint32_t start = cellOf(root % bc, root / bc, 0, 0);
+    cycle.order.resize(freeCells);
+    uint32_t cell = start;
+    for (size_t i = 0; i < freeCells; i++) {
+        cycle.order[i] = cell;
+        cell = successor[cell];
+    }
+    return cell == start && indexCycle(cycle, free, threads);
+}
+
+// Depth-first search for a cycle, taking the neighbour with the fewest
+// ways on first and backing out as soon as a cell is left with fewer than
+// two ways in and out or the rest of the region is cut off; false if none
+// is found within CYCLE_SEARCH_STEPS.
+inline bool searchCycle(HamiltonianCycle& cycle, const std::vector<uint8_t>& free, size_t freeCells)
+{
+    int cols = cycle.cols, rows = cycle.rows;
+    auto neighbours = [&](uint32_t cell, uint32_t* out) {
+        int x = cell % cols, y = cell / cols, n = 0;
+        const int steps[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+        for (const int* s : steps) {
+            int nx = x + s[0], ny = y + s[1];
+            if (nx >= 0 && ny >= 0 && nx < cols && ny < rows && free[(size_t)ny * cols + nx]) {
+                out[n++] = (uint32_t)(ny * cols + nx);
+            }
+        }
+        return n;
+    };
+
+    std::vector<uint8_t> visited(free.size(), 0);
+    auto waysOn = [&](uint32_t cell) {
+        uint32_t nb[4];
+        int n = neighbours(cell, nb), ways = 0;
+        for (int i = 0; i < n; i++) {
+            ways += !visited[nb[i]];
+        }
+        return ways;
+    };
+
+    uint32_t start = CYCLE_NONE;
+    int fewest = 5;
+    for (uint32_t cell = 0; cell < free.size(); cell++) {
+        uint32_t nb[4];
+        int n = free[cell] ? neighbours(cell, nb) : 5;
+        if (n < 2 && free[cell]) {
+            return false;
+        }
+        if (n < fewest) {
+            fewest = n;
+            start = cell;
+        }
+    }
+
+    struct Frame {
+        uint32_t cell;
+        uint32_t options[4];
+        int count, next;
+    };
+    std::vector<Frame> path;
+    path.reserve(freeCells);
+    auto enter = [&](uint32_t cell) {
+        visited[cell] = 1;
+        Frame f = {cell, {}, 0, 0};
+        uint32_t nb[4];
+        int n = neighbours(cell, nb);
+        for (int i = 0; i < n; i++) {
+            if (!visited[nb[i]]) {
+                f.options[f.count++] = nb[i];
+            }
+        }
+        std::sort(f.options, f.options + f.count, [&](uint32_t a, uint32_t b) { return waysOn(a) < waysOn(b); });
+        path.push_back(f);
+    };
+    // Every unvisited neighbour of the cell just left still needs two ways:
+    // unvisited cells, the new end of the path or, to close, the start.
+    auto stranded = [&](uint32_t left, uint32_t end) {
+        uint32_t nb[4], nb2[4];
+        int n = neighbours(left, nb);
+        for (int i = 0; i < n; i++) {
+            if (visited[nb[i]]) {
+                continue;
+            }
+            int m = neighbours(nb[i], nb2), ways = 0;
+            for (int k = 0; k < m; k++) {
+                ways += !visited[nb2[k]] || nb2[k] == end || nb2[k] == start;
+            }
+            if (ways < 2) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // The unvisited cells must all be reachable from the new end of the
+    // path, and the start from one of them, or the path cannot close.
+    std::vector<uint32_t> reach;
+    std::vector<uint32_t> reachedAt(free.size(), 0);
+    uint32_t generation = 0;
+    auto cutOff = [&](uint32_t end) {
+        generation++;
+        reach.assign(1, end);
+        reachedAt[end] = generation;
+        size_t unvisited = 0;
+        bool closes = false;
+        for (size_t q = 0; q < reach.size(); q++) {
+            uint32_t nb[4];
+            int n = neighbours(reach[q], nb);
+            for (int i = 0; i < n; i++) {
+                closes = closes || nb[i] == start;
+                if (!visited[nb[i]] && reachedAt[nb[i]] != generation) {
+                    reachedAt[nb[i]] = generation;
+                    reach.push_back(nb[i]);
+                    unvisited++;
+                }
+            }
+        }
+        return !closes || unvisited + path.size() + 1 != freeCells;
+    };
+
+    enter(start);
+    uint64_t steps = 0;
+    while (!path.empty() && steps++ < CYCLE_SEARCH_STEPS) {
+        Frame& top = path.back();
+        if (path.size() == freeCells) {
+            uint32_t nb[4];
+            int n = neighbours(top.cell, nb);
+            if (std::find(nb, nb + n, start) != nb + n) {
+                cycle.order.resize(freeCells);
+                for (size_t i = 0; i < freeCells; i++) {
+                    cycle.order[i] = path[i].cell;
+                }
+                return indexCycle(cycle, free, 1);
+            }
+        }
+        if (top.next == top.count || path.size() == freeCells) {
+            visited[top.cell] = 0;
+            path.pop_back();
+            continue;
+        }
+        uint32_t cell = top.options[top.next++];
+        if (visited[cell]) {
+            continue;
+        }
+        uint32_t left = top.cell;
+        visited[cell] = 1;
+        bool dead = stranded(left, cell) || cutOff(cell);
+        visited[cell] = 0;
+        if (!dead) {
+            enter(cell);
+        }
+    }
+    return false;
+}
+
+// A cycle over every free cell of a cols x rows board, or an empty one if
+// there is none (or none was found).
+inline HamiltonianCycle buildCycle(int cols, int rows, const std::vector<uint8_t>& free, int threads)
+{
+    HamiltonianCycle cycle;
+    cycle.cols = cols;
+    cycle.rows = rows;
+    size_t colours[2] = {0, 0};
+    for (size_t cell = 0; cell < free.size(); cell++) {
+        if (free[cell]) {
+            colours[(cell % cols + cell / cols) % 2]++;
+        }
+    }
+    size_t freeCells = colours[0] + colours[1];
+    if (freeCells < 4 || colours[0] != colours[1]) {
+        return cycle;
+    }
+    for (int offset = 0; offset < 4; offset++) {
+        if (blockCycle(cycle, free, freeCells, offset % 2, offset / 2, threads)) {
+            return cycle;
+        }
+    }
+    if (freeCells <= CYCLE_SEARCH_CELLS && searchCycle(cycle, free, freeCells)) {
+        return cycle;
+    }
+    cycle.order.clear();
+    cycle.index.clear();
+    return cycle;
+}
+
+inline std::string cycleFileFor(int cols, int rows, uint32_t maskCrc, const std::string& dir = CYCLE_DIR)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "/%dx%d-%08x.cycle", cols, rows, maskCrc);
+    return dir + name;
+}
+
+// Loads a cycle written by saveCycle; false if there is none for this
+// mask or it is damaged. found is false if the file says there is no cycle.
+inline bool loadCycle(const std::string& path, int cols, int rows, const std::vector<uint8_t>& free, uint32_t maskCrc, int threads,
+                      HamiltonianCycle& cycle, bool& found)
+{
+    MappedFile file(path);
+    CycleFileHeader header;
+    if (!file.data() || file.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != CYCLE_MAGIC || header.version != CYCLE_VERSION || header.cols != (uint32_t)cols ||
+        header.rows != (uint32_t)rows || header.maskCrc != maskCrc ||
+        file.size() != sizeof(header) + (size_t)header.length * sizeof(uint32_t) ||
+        crc32(file.data() + sizeof(header), file.size() - sizeof(header)) != header.crc) {
+        std::cout << "Ignoring damaged cycle cache " << path << std::endl;
+        return false;
+    }
+    cycle.cols = cols;
+    cycle.rows = rows;
+    cycle.order.resize(header.length);
+    memcpy(cycle.order.data(), file.data() + sizeof(header), (size_t)header.length * sizeof(uint32_t));
+    found = header.length > 0;
+    if (found && !indexCycle(cycle, free, threads)) {
+        std::cout << "Ignoring cycle cache " << path << ", which does not fit its board" << std::endl;
+        cycle.order.clear();
+        return false;
+    }
+    return true;
+}
+
+// Writes the cycle (or, if it is empty, that there is none) to path by way
+// of a temp file, so a reader never sees half of one.
+inline bool saveCycle(const std::string& path, const HamiltonianCycle& cycle, uint32_t maskCrc)
+{
+    CycleFileHeader header = {CYCLE_MAGIC, CYCLE_VERSION, 0, (uint32_t)cycle.cols, (uint32_t)cycle.rows, maskCrc,
+                              (uint32_t)cycle.order.size(), 0, 0};
+    header.crc = crc32(cycle.order.data(), cycle.order.size() * sizeof(uint32_t));
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(cycle.order.data()), cycle.order.size() * sizeof(uint32_t));
+        if (!file) {
+            std::cout << "Error: Could not write cycle cache " << path << std::endl;
+            return false;
+        }
+    }
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        std::cout << "Error: Could not write cycle cache " << path << ": " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// The cycle for this board from the cache, built and cached first if it
+// is not there yet; empty if the board has none.
+inline HamiltonianCycle cachedCycle(int cols, int rows, const std::vector<uint8_t>& free, int threads,
+                                    const std::string& dir = CYCLE_DIR)
+{
+    uint32_t maskCrc = crc32(free.data(), free.size());
+    std::string path = cycleFileFor(cols, rows, maskCrc, dir);
+    HamiltonianCycle cycle;
+    bool found;
+    if (loadCycle(path, cols, rows, free, maskCrc, threads, cycle, found)) {
+        return cycle;
+    }
+    auto start = std::chrono::steady_clock::now();
+    cycle = buildCycle(cols, rows, free, threads);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << (cycle.empty() ? "No Hamiltonian cycle" : "Built a Hamiltonian cycle") << " for the " << cols << "x" << rows
+              << " board in " << ms << " ms" << std::endl;
+    saveCycle(path, cycle, maskCrc);
+    return cycle;
+}
+
+inline HamiltonianCycle cachedCycle(const CoreRules& rules, int threads)
+{
+    return cachedCycle(rules.screenWidth / rules.cellSize, rules.screenHeight / rules.cellSize, cycleMask(rules), threads);
+}
+
+class CycleAutopilot {
+public:
+    explicit CycleAutopilot(const HamiltonianCycle& cycle) : cycle(cycle) {}
+
+    // The cell the head should move to next. targets are the cells worth
+    // cutting across the cycle for (food, bonus); any off the cycle are
+    // ignored. Until the body lies along the cycle (the player was steering
+    // before), this only keeps to the cycle where it can and otherwise
+    // avoids the body.
+    template <class Body>
+    uint32_t nextCell(const Body& body, const uint32_t* targets, int targetCount) const
+    {
+        size_t n = cycle.size();
+        uint32_t head = body.cellAt(0), tail = body.cellAt(body.size() - 1);
+        uint32_t around[4];
+        int count = neighbours(head, around);
+        if (!alongCycle(body)) {
+            uint32_t next = cycle.contains(head) ? cycle.next(head) : CYCLE_NONE;
+            if (next != CYCLE_NONE && (!body.occupiesCell(next) || next == tail)) {
+                return next;
+            }
+            for (int i = 0; i < count; i++) {
+                if (!body.occupiesCell(around[i]) || around[i] == tail) {
+                    return around[i];
+                }
+            }
+            return next != CYCLE_NONE ? next : head;
+        }
+
+        uint32_t best = cycle.next(head);
+        if (body.size() * 2 >= n) {
+            return best;
+        }
+        size_t toTail = body.size() > 1 ? cycle.distance(head, tail) : n;
+        size_t toTarget = n;
+        for (int i = 0; i < targetCount; i++) {
+            if (cycle.contains(targets[i])) {
+                toTarget = std::min(toTarget, cycle.distance(head, targets[i]));
+            }
+        }
+        // Room for the tail to stand still while the snake eats.
+        const size_t room = 2;
+        size_t bestDistance = 1;
+        for (int i = 0; i < count; i++) {
+            size_t d = cycle.distance(head, around[i]);
+            if (d > bestDistance && d <= toTarget && d + room < toTail) {
+                best = around[i];
+                bestDistance = d;
+            }
+        }
+        return best;
+    }
+
+private:
+    const HamiltonianCycle& cycle;
+
+    // head's neighbours on the cycle.
+    int neighbours(uint32_t head, uint32_t* out) const
+    {
+        int x = head % cycle.cols, y = head / cycle.cols, n = 0;
+        const int steps[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+        for (const int* s : steps) {
+            int nx = x + s[0], ny = y + s[1];
+            if (nx >= 0 && ny >= 0 && nx < cycle.cols && ny < cycle.rows && cycle.contains((uint32_t)(ny * cycle.cols + nx))) {
+                out[n++] = (uint32_t)(ny * cycle.cols + nx);
+            }
+        }
+        return n;
+    }
+
+    // True if every segment is on the cycle and they come in cycle order,
+    // tail to head, inside one lap.
+    template <class Body>
+    bool alongCycle(const Body& body) const
+    {
+        size_t lap = 0;
+        uint32_t previous = CYCLE_NONE;
+        bool along = true;
+        body.forEachCell([&](uint32_t cell) {
+            if (!cycle.contains(cell)) {
+                along = false;
+            } else if (along && previous != CYCLE_NONE) {
+                size_t d = cycle.distance(cell, previous);
+                along = d > 0;
+                lap += d;
+            }
+            previous = cell;
+        });
+        return along && lap < cycle.size();
+    }
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+// Minimal image encoders for headless output: RGB PNG and YUV4MPEG2
+// (raw 4:2:0 video that ffmpeg and most players read directly).
+// The PNG deflate stream uses the fixed Huffman code and only looks for
+// "same as the pixel to the left" runs. That is nowhere near zlib's ratio
+// on photos, but game frames are mostly flat colour and it is fast.
+
+#include <bits/stdc++.h>
+#include "crc32.h"
+#include "deflate.h"
+
+inline void appendPngChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t size)
+{
+    appendBigEndian(out, (uint32_t)size);
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    appendBigEndian(out, crc32(&out[start], size + 4));
+}
+
+// Encodes RGBA pixels (alpha dropped) as an 8-bit RGB PNG into out.
+// scratch holds the filtered scanlines and can be reused between calls.
+inline void encodePng(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out, std::vector<uint8_t>& scratch)
+{
+    size_t rowBytes = width * 3 + 1;
+    std::vector<uint8_t>& raw = scratch;
+    raw.resize(rowBytes * height);
+    for (int y = 0; y < height; y++) {
+        uint8_t* row = &raw[y * rowBytes];
+        const uint8_t* src = rgba + (size_t)y * width * 4;
+        row[0] = 0; // filter: none
+        for (int x = 0; x < width; x++) {
+            row[1 + x * 3] = src[x * 4];
+            row[2 + x * 3] = src[x * 4 + 1];
+            row[3 + x * 3] = src[x * 4 + 2];
+        }
+    }
+
+    std::vector<uint8_t> zlib;
+    zlib.reserve(raw.size() / 8 + 64);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+    DeflateBits bits(zlib);
+    bits.put(1, 1); // final block
+    bits.put(1, 2); // fixed Huffman
+    size_t i = 0;
+    while (i < raw.size()) {
+        size_t run = 0;
+        if (i >= 3) {
+            while (run < 258 && i + run < raw.size() && raw[i + run] == raw[i + run - 3]) {
+                run++;
+            }
+        }
+        if (run >= 3) {
+            bits.match((int)run);
+            i += run;
+        } else {
+            bits.literal(raw[i]);
+            i++;
+        }
+    }
+    bits.literal(256);
+    bits.flush();
+    appendBigEndian(zlib, adler32(raw.data(), raw.size()));
+
+    static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.clear();
+    out.insert(out.end(), signature, signature + 8);
+
+    uint8_t ihdr[13] = {};
+    for (int k = 0; k < 4; k++) {
+        ihdr[k] = (uint8_t)(width >> (24 - 8 * k));
+        ihdr[4 + k] = (uint8_t)(height >> (24 - 8 * k));
+    }
+    ihdr[8] = 8; // bit depth
+    ihdr[9] = 2; // colour type: RGB
+    appendPngChunk(out, "IHDR", ihdr, sizeof(ihdr));
+    appendPngChunk(out, "IDAT", zlib.data(), zlib.size());
+    appendPngChunk(out, "IEND", nullptr, 0);
+}
+
+inline std::string y4mHeader(int width, int height, int fps)
+{
+    return "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) + " F" + std::to_string(fps) +
+           ":1 Ip A1:1 C420jpeg\n";
+}
+
+// One "FRAME" record: BT.601 studio-range Y plane plus 2x2-averaged U, V.
+inline void encodeY4mFrame(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& out)
+{
+    const char tag[] = "FRAME\n";
+    int cw = (width + 1) / 2, ch = (height + 1) / 2;
+    out.resize(6 + width * height + 2 * cw * ch);
+    memcpy(out.data(), tag, 6);
+    uint8_t* yPlane = out.data() + 6;
+    uint8_t* uPlane = yPlane + width * height;
+    uint8_t* vPlane = uPlane + cw * ch;
+
+    for (int i = 0; i < width * height; i++) {
+        const uint8_t* p = rgba + i * 4;
+        yPlane[i] = (uint8_t)(16 + ((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8));
+    }
+
+    for (int cy = 0; cy < ch; cy++) {
+        for (int cx = 0; cx < cw; cx++) {
+            int r = 0, g = 0, b = 0, n = 0;
+            for (int dy = 0; dy < 2; dy++) {
+                for (int dx = 0; dx < 2; dx++) {
+                    int x = cx * 2 + dx, y = cy * 2 + dy;
+                    if (x < width && y < height) {
+                        const uint8_t* p = rgba + (y * width + x) * 4;
+                        r += p[0];
+                        g += p[1];
+                        b += p[2];
+                        n++;
+                    }
+                }
+            }
+            r /= n;
+            g /= n;
+            b /= n;
+            uPlane[cy * cw + cx] = (uint8_t)(128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+            vPlane[cy * cw + cx] = (uint8_t)(128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+        }
+    }
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+// Input-to-present latency. Every key press that changes the snake's
+// direction gets a sequence number, which travels to the simulation thread
+// packed next to the direction. The first tick that reads it stamps the
+// snapshot with the sequence number and the tick time. The main thread
+// then records three intervals as soon as a frame showing that snapshot
+// has been presented:
+//   input to tick     waiting for the tick gate
+//   tick to present   publishing, picking up and drawing the snapshot
+//   input to present  the whole delay the player sees
+// Presses never shown on a frame of their own (replaced before a tick read
+// them, or their frame was dropped for a newer one) count as superseded.
+// "Present" is when SDL_RenderPresent returned; anything after that
+// (compositor, display) is not visible from here.
+//
+// InputInjector stands in for the player: it presses a turn at seeded,
+// random intervals (or early, to avoid a crash), choosing one that does
+// not run into the border or the body, and continues (task301's y) when the game is paused, so the
+// probe can be run without a human at the keyboard.
+
+#include <SDL2/SDL.h>
+#include <bits/stdc++.h>
+#include "timing_stats.h"
+
+const int LATENCY_PENDING = 64; // presses in flight at once
+
+class LatencyProbe {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // A press that changed the direction; returns its sequence number,
+    // never 0.
+    uint32_t inputChanged(Clock::time_point at)
+    {
+        uint32_t seq = ++lastSeq;
+        pressedAt[seq % LATENCY_PENDING] = at;
+        return seq;
+    }
+
+    // A frame was presented showing the simulation up to press seq, which
+    // the tick at appliedAt read first.
+    void presented(uint32_t seq, Clock::time_point appliedAt, Clock::time_point at)
+    {
+        if (seq == 0 || seq == lastShown) {
+            return;
+        }
+        superseded += seq - lastShown - 1;
+        lastShown = seq;
+        if (lastSeq - seq >= LATENCY_PENDING) {
+            return; // its press time was overwritten
+        }
+        Clock::time_point pressed = pressedAt[seq % LATENCY_PENDING];
+        inputToTick.record(elapsedNanos(pressed, appliedAt));
+        tickToPresent.record(elapsedNanos(appliedAt, at));
+        inputToPresent.record(elapsedNanos(pressed, at));
+    }
+
+    void print(std::ostream& out) const
+    {
+        inputToTick.print(out, "input to tick");
+        tickToPresent.print(out, "tick to present");
+        inputToPresent.print(out, "input to present");
+        out << "superseded inputs: " << superseded << std::endl;
+    }
+
+private:
+    Clock::time_point pressedAt[LATENCY_PENDING];
+    uint32_t lastSeq = 0;
+    uint32_t lastShown = 0;
+    uint64_t superseded = 0;
+    TimingStats inputToTick, tickToPresent, inputToPresent;
+};
+
+class InputInjector {
+public:
+    InputInjector(int presses, uint64_t seed) : remaining(presses), random(seed)
+    {
+        next = std::chrono::steady_clock::now() + interval();
+    }
+
+    // Presses left to inject.
+    bool active() const
+    {
+        return remaining > 0;
+    }
+
+    // All presses injected and the last one given time to reach the screen.
+    bool done() const
+    {
+        return remaining == 0 && std::chrono::steady_clock::now() >= next;
+    }
+
+    // Pushes a key press onto the SDL queue when one is due, or early if
+    // the snake is about to hit something. snake is the latest snapshot's
+    // body as cells (head first); dx, dy the current direction in pixels.
+    void poll(const uint32_t* snake, int length, int dx, int dy, int cellSize, int screenWidth, int screenHeight, bool paused = false)
+    {
+        int cols = screenWidth / cellSize;
+        int headX = (int)(snake[0] % cols) * cellSize, headY = (int)(snake[0] / cols) * cellSize;
+        auto safe = [&](int x, int y) {
+            if (x < cellSize || x >= screenWidth - cellSize || y < cellSize || y >= screenHeight - cellSize) {
+                return false;
+            }
+            uint32_t cell = (uint32_t)(y / cellSize * cols + x / cellSize);
+            for (int s = 1; s < length; s++) {
+                if (snake[s] == cell) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        auto now = std::chrono::steady_clock::now();
+        if (remaining == 0 || (now < next && (paused || safe(headX + dx, headY + dy)))) {
+            return;
+        }
+        next = now + interval();
+        if (paused) {
+            push(SDLK_y);
+            return;
+        }
+
+        // The two turns, in random order; the first that is safe.
+        const SDL_Keycode keys[2][2] = {{SDLK_UP, SDLK_DOWN}, {SDLK_LEFT, SDLK_RIGHT}};
+        const SDL_Keycode* turns = dx != 0 ? keys[0] : keys[1];
+        int first = random() % 2;
+        for (int i = 0; i < 2; i++) {
+            SDL_Keycode key = turns[(first + i) % 2];
+            int tx = key == SDLK_LEFT ? -cellSize : key == SDLK_RIGHT ? cellSize : 0;
+            int ty = key == SDLK_UP ? -cellSize : key == SDLK_DOWN ? cellSize : 0;
+            if (safe(headX + tx, headY + ty)) {
+                push(key);
+                if (--remaining == 0) {
+                    next = now + std::chrono::milliseconds(500);
+                }
+                return;
+            }
+        }
+    }
+
+private:
+    int remaining;
+    std::mt19937_64 random;
+    std::chrono::steady_clock::time_point next;
+
+    static void push(SDL_Keycode key)
+    {
+        SDL_Event event = {};
+        event.type = SDL_KEYDOWN;
+        event.key.timestamp = SDL_GetTicks();
+        event.key.keysym.sym = key;
+        SDL_PushEvent(&event);
+    }
+
+    // Between one and four ticks of the slowest game.
+    std::chrono::milliseconds interval()
+    {
+        return std::chrono::milliseconds(120 + random() % 360);
+    }
+};
@@ -0,0 +1,246 @@
+#pragma once
+
+// Top-N leaderboard kept in a small binary file (highscore.dat).
+// The file is read once per process; every update is written by a
+// background thread as temp file -> fsync -> rename, so the game-over
+// screen never waits on the disk and a crash can never leave a torn file.
+
+#include <bits/stdc++.h>
+#include "crc32.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+const int LEADERBOARD_SIZE = 10;
+const char* const LEADERBOARD_FILE = "highscore.dat";
+const char* const LEADERBOARD_TEMP_FILE = "highscore.dat.tmp";
+const char* const LEGACY_HIGHSCORE_FILE = "highscore.txt";
+const uint32_t LEADERBOARD_MAGIC = 0x424C4E53; // "SNLB"
+const uint16_t LEADERBOARD_VERSION = 1;
+
+struct LeaderboardEntry {
+    int32_t score;
+    int32_t length;
+    int64_t timestamp;
+};
+
+struct LeaderboardFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+};
+
+class LeaderboardStore {
+public:
+    ~LeaderboardStore()
+    {
+        flush();
+    }
+
+    const std::vector<LeaderboardEntry>& entries()
+    {
+        load();
+        return board;
+    }
+
+    int topScore()
+    {
+        load();
+        return board.empty() ? 0 : board[0].score;
+    }
+
+    // Inserts the result into the in-memory board and queues a write if it placed.
+    // Returns the 1-based rank, or 0 if the score did not make the board.
+    int submit(int score, int length)
+    {
+        load();
+        if (score <= 0) {
+            return 0;
+        }
+
+        LeaderboardEntry entry = {score, length, (int64_t)time(nullptr)};
+        auto pos = std::upper_bound(board.begin(), board.end(), entry,
+            [](const LeaderboardEntry& a, const LeaderboardEntry& b) { return a.score > b.score; });
+        int rank = (int)(pos - board.begin()) + 1;
+        if (rank > LEADERBOARD_SIZE) {
+            return 0;
+        }
+
+        board.insert(pos, entry);
+        if ((int)board.size() > LEADERBOARD_SIZE) {
+            board.pop_back();
+        }
+        queueWrite();
+        return rank;
+    }
+
+    // Blocks until every queued write has reached the disk and stops the I/O thread.
+    void flush()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!writer.joinable()) {
+                return;
+            }
+            stopping = true;
+        }
+        wake.notify_one();
+        writer.join();
+        stopping = false;
+    }
+
+private:
+    std::vector<LeaderboardEntry> board;
+    bool loaded = false;
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<LeaderboardEntry> pending;
+    bool hasPending = false;
+    bool stopping = false;
+
+    void load()
+    {
+        if (loaded) {
+            return;
+        }
+        loaded = true;
+
+        if (readFile()) {
+            return;
+        }
+
+        // First run after the text format: carry the old high score over.
+        std::ifstream legacy(LEGACY_HIGHSCORE_FILE);
+        int highScore = 0;
+        if (legacy >> highScore && highScore > 0) {
+            board.push_back({highScore, 0, 0});
+            queueWrite();
+        }
+    }
+
+    bool readFile()
+    {
+        std::ifstream inFile(LEADERBOARD_FILE, std::ios::binary);
+        if (!inFile.is_open()) {
+            return false;
+        }
+
+        LeaderboardFileHeader header;
+        if (!inFile.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            header.magic != LEADERBOARD_MAGIC || header.version != LEADERBOARD_VERSION ||
+            header.count > LEADERBOARD_SIZE) {
+            std::cout << "Ignoring unreadable leaderboard file " << LEADERBOARD_FILE << std::endl;
+            return false;
+        }
+
+        std::vector<LeaderboardEntry> entries(header.count);
+        uint32_t storedCrc = 0;
+        inFile.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(LeaderboardEntry));
+        inFile.read(reinterpret_cast<char*>(&storedCrc), sizeof(storedCrc));
+        if (!inFile) {
+            std::cout << "Leaderboard file " << LEADERBOARD_FILE << " is truncated" << std::endl;
+            return false;
+        }
+
+        uint32_t crc = crc32(&header, sizeof(header));
+        crc = crc32(entries.data(), entries.size() * sizeof(LeaderboardEntry), crc);
+        if (crc != storedCrc) {
+            std::cout << "Leaderboard file " << LEADERBOARD_FILE << " failed its checksum" << std::endl;
+            return false;
+        }
+
+        board = entries;
+        return true;
+    }
+
+    void queueWrite()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending = board;
+            hasPending = true;
+            if (!writer.joinable()) {
+                writer = std::thread(&LeaderboardStore::writerLoop, this);
+            }
+        }
+        wake.notify_one();
+    }
+
+    void writerLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return hasPending || stopping; });
+            if (hasPending) {
+                std::vector<LeaderboardEntry> snapshot;
+                snapshot.swap(pending);
+                hasPending = false;
+
+                lock.unlock();
+                writeFile(snapshot);
+                lock.lock();
+                continue;
+            }
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    static bool writeFile(const std::vector<LeaderboardEntry>& entries)
+    {
+        LeaderboardFileHeader header = {LEADERBOARD_MAGIC, LEADERBOARD_VERSION, (uint16_t)entries.size()};
+        uint32_t crc = crc32(&header, sizeof(header));
+        crc = crc32(entries.data(), entries.size() * sizeof(LeaderboardEntry), crc);
+
+        std::vector<char> bytes(sizeof(header) + entries.size() * sizeof(LeaderboardEntry) + sizeof(crc));
+        char* out = bytes.data();
+        memcpy(out, &header, sizeof(header));
+        out += sizeof(header);
+        memcpy(out, entries.data(), entries.size() * sizeof(LeaderboardEntry));
+        out += entries.size() * sizeof(LeaderboardEntry);
+        memcpy(out, &crc, sizeof(crc));
+
+#ifdef _WIN32
+        int fd = _open(LEADERBOARD_TEMP_FILE, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+        bool ok = fd >= 0 && _write(fd, bytes.data(), (unsigned)bytes.size()) == (int)bytes.size() && _commit(fd) == 0;
+        if (fd >= 0) {
+            _close(fd);
+        }
+        ok = ok && MoveFileExA(LEADERBOARD_TEMP_FILE, LEADERBOARD_FILE, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+        int fd = open(LEADERBOARD_TEMP_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        bool ok = fd >= 0 && write(fd, bytes.data(), bytes.size()) == (ssize_t)bytes.size() && fsync(fd) == 0;
+        if (fd >= 0) {
+            close(fd);
+        }
+        ok = ok && rename(LEADERBOARD_TEMP_FILE, LEADERBOARD_FILE) == 0;
+        if (ok) {
+            // Make the rename itself durable.
+            int dirFd = open(".", O_RDONLY);
+            if (dirFd >= 0) {
+                fsync(dirFd);
+                close(dirFd);
+            }
+        }
+#endif
+
+        if (!ok) {
+            std::cout << "Error: Could not write leaderboard file " << LEADERBOARD_FILE << std::endl;
+        }
+        return ok;
+    }
+};
+
+inline LeaderboardStore& leaderboard()
+{
+    static LeaderboardStore store;
+    return store;
+}
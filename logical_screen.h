@@ -0,0 +1,93 @@
+#pragma once
+
+// The games and their menus draw a fixed 640x480 scene in their own
+// coordinates. Once attached, every frame is drawn into a texture of that
+// size and copied to the window once, at present, scaled by the largest
+// whole number that fits (centred, black around it) or, in a window smaller
+// than the scene, shrunk to fit; always nearest-neighbour, so pixels stay
+// sharp. Drawing costs the same whatever the window's size, and the one
+// scaled copy is all that grows with it. Mouse positions are mapped back
+// with toLogical.
+//
+// Without a window (the offscreen software renderer) nothing is attached
+// and frames are presented as drawn. A renderer that cannot draw to
+// textures falls back to SDL's own logical size, which scales every draw
+// call instead.
+
+#include <SDL2/SDL.h>
+#include <bits/stdc++.h>
+#include "resources.h"
+
+class LogicalScreen {
+public:
+    void attach(SDL_Renderer* renderer, int w, int h)
+    {
+        width = w;
+        height = h;
+        shown = {0, 0, w, h};
+        if (SDL_RenderTargetSupported(renderer)) {
+            SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+            target = ownTexture(SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h));
+        }
+        if (!target) {
+            std::cout << "No render target (" << SDL_GetError() << "), scaling each draw instead" << std::endl;
+            SDL_RenderSetLogicalSize(renderer, w, h);
+            SDL_RenderSetIntegerScale(renderer, SDL_TRUE);
+        }
+    }
+
+    // Before the renderer goes.
+    void detach()
+    {
+        target.reset();
+    }
+
+    // At the start of every frame.
+    void begin(SDL_Renderer* renderer)
+    {
+        if (target) {
+            SDL_SetRenderTarget(renderer, target.get());
+        }
+    }
+
+    void present(SDL_Renderer* renderer)
+    {
+        if (target) {
+            int w = 0, h = 0;
+            SDL_GetRendererOutputSize(renderer, &w, &h);
+            int scale = std::min(w / width, h / height);
+            if (scale >= 1) {
+                shown = {(w - width * scale) / 2, (h - height * scale) / 2, width * scale, height * scale};
+            } else if ((int64_t)w * height < (int64_t)h * width) {
+                shown = {0, (h - w * height / width) / 2, w, w * height / width};
+            } else {
+                shown = {(w - h * width / height) / 2, 0, h * width / height, h};
+            }
+            SDL_SetRenderTarget(renderer, nullptr);
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+            SDL_RenderClear(renderer);
+            SDL_RenderCopy(renderer, target.get(), nullptr, &shown);
+        }
+        SDL_RenderPresent(renderer);
+    }
+
+    // A window position in scene coordinates.
+    void toLogical(int& x, int& y) const
+    {
+        if (target && shown.w > 0 && shown.h > 0) {
+            x = (int)floor((x - shown.x) * (double)width / shown.w);
+            y = (int)floor((y - shown.y) * (double)height / shown.h);
+        }
+    }
+
+private:
+    TextureHandle target;
+    int width = 0, height = 0;
+    SDL_Rect shown = {0, 0, 0, 0}; // where the scene went on the last present
+};
+
+inline LogicalScreen& logicalScreen()
+{
+    static LogicalScreen screen;
+    return screen;
+}
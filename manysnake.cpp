@@ -0,0 +1,153 @@
+    #include <SDL2/SDL.h>
+    #include <bits/stdc++.h>
+    #include "snake_world.h"
+    #include "snake_ai.h"
+
+    using namespace std;
+
+    // Local many-snake mode: manysnake [snakes] [width] [height]
+    // Snake 0 is yours (arrow keys); every other snake is AI controlled.
+    // Collisions go through the world's owner-tagged grid.
+
+    const int SCREEN_WIDTH = 640;
+    const int SCREEN_HEIGHT = 480;
+    const int TICK_MS = 50;
+    const int RESPAWN_TICKS = 40;
+
+    void handleEvents(bool& quit, SnakeWorld& world);
+    void stepWorld(SnakeWorld& world, vector<SnakeBrain>& brains, mt19937& rng);
+    void renderWorld(SDL_Renderer* renderer, const SnakeWorld& world, vector<SDL_Rect>& rects);
+
+    int main(int argc, char* argv[])
+    {
+        int snakes = argc > 1 ? atoi(argv[1]) : 300;
+        int width = argc > 2 ? atoi(argv[2]) : 320;
+        int height = argc > 3 ? atoi(argv[3]) : 240;
+        if (snakes < 1 || width < 8 || height < 8) {
+            cout << "usage: manysnake [snakes] [width] [height]" << endl;
+            return 1;
+        }
+
+        if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+            cout << "SDL could not initialize! SDL_Error: " << SDL_GetError() << endl;
+            return 1;
+        }
+        SDL_Window* window = SDL_CreateWindow("Snake Swarm", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                              SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+        SDL_Renderer* renderer = window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED) : nullptr;
+        if (!renderer) {
+            cout << "Renderer could not be created! SDL_Error: " << SDL_GetError() << endl;
+            return 1;
+        }
+
+        SnakeWorld world(width, height, max(16, snakes), (uint32_t)time(nullptr));
+        world.recordDelta = false;
+        vector<SnakeBrain> brains(snakes);
+        mt19937 rng((uint32_t)time(nullptr));
+        for (int i = 0; i < snakes; i++) {
+            world.addSnake();
+            world.spawnSnake(i);
+        }
+        world.refillFood();
+
+        vector<SDL_Rect> rects;
+        bool quit = false;
+        Uint32 lastMove = SDL_GetTicks();
+        while (!quit) {
+            handleEvents(quit, world);
+
+            if (SDL_GetTicks() - lastMove > TICK_MS) {
+                lastMove = SDL_GetTicks();
+                stepWorld(world, brains, rng);
+                renderWorld(renderer, world, rects);
+            } else {
+                SDL_Delay(1);
+            }
+        }
+
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return 0;
+    }
+
+    void handleEvents(bool& quit, SnakeWorld& world)
+    {
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) {
+                quit = true;
+            } else if (event.type == SDL_KEYDOWN) {
+                switch (event.key.keysym.sym) {
+                    case SDLK_UP: world.setDirection(0, DIR_UP); break;
+                    case SDLK_DOWN: world.setDirection(0, DIR_DOWN); break;
+                    case SDLK_LEFT: world.setDirection(0, DIR_LEFT); break;
+                    case SDLK_RIGHT: world.setDirection(0, DIR_RIGHT); break;
+                    case SDLK_ESCAPE: quit = true; break;
+                }
+            }
+        }
+    }
+
+    void stepWorld(SnakeWorld& world, vector<SnakeBrain>& brains, mt19937& rng)
+    {
+        for (size_t id = 0; id < world.snakes.size(); id++) {
+            const WorldSnake& s = world.snakes[id];
+            if (!s.alive) {
+                if (world.tick - s.diedAtTick >= RESPAWN_TICKS) {
+                    world.spawnSnake((int)id);
+                }
+            } else if (id != 0) {
+                world.setDirection((int)id, steerSnake(world, (int)id, brains[id], rng));
+            }
+        }
+        world.advance();
+    }
+
+    void renderWorld(SDL_Renderer* renderer, const SnakeWorld& world, vector<SDL_Rect>& rects)
+    {
+        int cellSize = max(1, min(SCREEN_WIDTH / world.width, SCREEN_HEIGHT / world.height));
+        int originX = (SCREEN_WIDTH - cellSize * world.width) / 2;
+        int originY = (SCREEN_HEIGHT - cellSize * world.height) / 2;
+        auto cellRect = [&](int cell) {
+            return SDL_Rect{originX + world.cellX(cell) * cellSize, originY + world.cellY(cell) * cellSize, cellSize, cellSize};
+        };
+
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+
+        SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
+        SDL_Rect walls[] = {
+            {originX, originY, world.width * cellSize, cellSize},
+            {originX, originY + (world.height - 1) * cellSize, world.width * cellSize, cellSize},
+            {originX, originY, cellSize, world.height * cellSize},
+            {originX + (world.width - 1) * cellSize, originY, cellSize, world.height * cellSize}
+        };
+        SDL_RenderFillRects(renderer, walls, 4);
+
+        rects.clear();
+        for (int32_t cell : world.food) {
+            rects.push_back(cellRect(cell));
+        }
+        SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+        SDL_RenderFillRects(renderer, rects.data(), (int)rects.size());
+
+        // One batched call per snake colour: AI snakes in grey, yours in green.
+        rects.clear();
+        for (size_t id = 1; id < world.snakes.size(); id++) {
+            for (int32_t cell : world.snakes[id].body) {
+                rects.push_back(cellRect(cell));
+            }
+        }
+        SDL_SetRenderDrawColor(renderer, 160, 160, 160, 255);
+        SDL_RenderFillRects(renderer, rects.data(), (int)rects.size());
+
+        rects.clear();
+        for (int32_t cell : world.snakes[0].body) {
+            rects.push_back(cellRect(cell));
+        }
+        SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
+        SDL_RenderFillRects(renderer, rects.data(), (int)rects.size());
+
+        SDL_RenderPresent(renderer);
+    }
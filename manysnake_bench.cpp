@@ -0,0 +1,98 @@
+#include <bits/stdc++.h>
+#include "snake_world.h"
+#include "snake_ai.h"
+
+using namespace std;
+
+// Headless benchmark for many-snake mode.
+//   manysnake_bench [--width W] [--height H] [--ticks N]
+// Sweeps 1 to 1,000 AI snakes on one board, then grows a fixed population
+// to show tick cost follows the number of snakes, not their total length.
+
+const int RESPAWN_TICKS = 20;
+
+struct Population {
+    SnakeWorld world;
+    vector<SnakeBrain> brains;
+    mt19937 rng;
+
+    Population(int width, int height, int snakes, int food)
+        : world(width, height, food, 12345), brains(snakes), rng(777)
+    {
+        world.recordDelta = false;
+        for (int i = 0; i < snakes; i++) {
+            world.addSnake();
+            world.spawnSnake(i);
+        }
+        world.refillFood();
+    }
+
+    void tick()
+    {
+        for (size_t id = 0; id < world.snakes.size(); id++) {
+            const WorldSnake& s = world.snakes[id];
+            if (s.alive) {
+                world.setDirection((int)id, steerSnake(world, (int)id, brains[id], rng));
+            } else if (world.tick - s.diedAtTick >= RESPAWN_TICKS) {
+                world.spawnSnake((int)id);
+            }
+        }
+        world.advance();
+    }
+
+    size_t segments() const
+    {
+        size_t total = 0;
+        for (const WorldSnake& s : world.snakes) {
+            total += s.body.size();
+        }
+        return total;
+    }
+};
+
+double timeTicks(Population& pop, int ticks)
+{
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ticks; i++) {
+        pop.tick();
+    }
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / ticks;
+}
+
+int main(int argc, char* argv[])
+{
+    int width = 512, height = 512, ticks = 2000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--width") width = atoi(argv[i + 1]);
+        else if (arg == "--height") height = atoi(argv[i + 1]);
+        else if (arg == "--ticks") ticks = atoi(argv[i + 1]);
+        else {
+            cout << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    cout << "Board " << width << "x" << height << ", " << ticks << " ticks per row" << endl;
+    cout << setw(8) << "snakes" << setw(10) << "alive" << setw(12) << "segments"
+         << setw(12) << "us/tick" << setw(14) << "ns/snake" << endl;
+
+    const int counts[] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+    for (int snakes : counts) {
+        Population pop(width, height, snakes, max(16, snakes));
+        timeTicks(pop, 200); // let the population settle
+        double us = timeTicks(pop, ticks);
+        cout << fixed << setprecision(2) << setw(8) << snakes << setw(10) << pop.world.aliveCount()
+             << setw(12) << pop.segments() << setw(12) << us << setw(14) << us * 1000 / snakes << endl;
+    }
+
+    cout << endl << "Growth run: 200 snakes with plenty of food" << endl;
+    cout << setw(8) << "tick" << setw(12) << "segments" << setw(12) << "us/tick" << endl;
+    Population pop(width, height, 200, 4000);
+    for (int window = 1; window <= 8; window++) {
+        double us = timeTicks(pop, ticks);
+        cout << fixed << setprecision(2) << setw(8) << pop.world.tick << setw(12) << pop.segments()
+             << setw(12) << us << endl;
+    }
+    return 0;
+}
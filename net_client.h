@@ -0,0 +1,465 @@
+#pragma once
+
+// Client side of the multiplayer protocol: joins a snake_server, sends
+// direction intents and keeps a replica of the board up to date from the
+// server's deltas. Used by both the SDL client and the bot client.
+
+#include "net_protocol.h"
+
+const uint8_t REPLICA_WALL = 0xFF;
+
+struct ReplicaSnake {
+    bool alive = false;
+    std::deque<int32_t> body; // front is the head
+};
+
+class BoardReplica {
+public:
+    int width = 0, height = 0;
+    uint32_t tick = 0;
+    bool synced = false;
+    std::vector<ReplicaSnake> snakes;
+    std::vector<int32_t> food;
+    std::vector<uint8_t> owner; // 0 empty, REPLICA_WALL, or snake id + 1
+
+    void reset(int w, int h)
+    {
+        width = w;
+        height = h;
+        tick = 0;
+        synced = false;
+        snakes.assign(NET_MAX_PLAYERS, ReplicaSnake());
+        food.clear();
+        foodSlot.assign(w * h, -1);
+        owner.assign(w * h, 0);
+        for (int x = 0; x < w; x++) {
+            owner[x] = owner[(h - 1) * w + x] = REPLICA_WALL;
+        }
+        for (int y = 0; y < h; y++) {
+            owner[y * w] = owner[y * w + w - 1] = REPLICA_WALL;
+        }
+    }
+
+    bool hasFood(int cell) const { return foodSlot[cell] >= 0; }
+
+    int step(int cell, int dir) const
+    {
+        static const int dx[] = {0, 1, 0, -1};
+        static const int dy[] = {-1, 0, 1, 0};
+        return cell + dy[dir] * width + dx[dir];
+    }
+
+    bool validCell(uint32_t cell) const
+    {
+        return cell < (uint32_t)(width * height);
+    }
+
+    // Applies a DELTA body in the order the server produced it: spawns,
+    // retired tails, new heads, deaths, then food. Returns false if the
+    // packet is malformed or the result does not match the server's hash.
+    bool applyDelta(PacketReader& in)
+    {
+        uint32_t hash = in.get32();
+        auto count = [&in]() {
+            uint32_t n = in.getVarint();
+            if (n > (uint32_t)in.remaining()) {
+                in.fail();
+                return 0u;
+            }
+            return n;
+        };
+
+        uint32_t n = count();
+        std::vector<std::pair<uint8_t, int32_t>> heads(n);
+        for (auto& h : heads) {
+            h.first = in.get8();
+            h.second = in.getVarint();
+        }
+        std::vector<uint8_t> tails(count());
+        for (uint8_t& id : tails) {
+            id = in.get8();
+        }
+        std::vector<uint8_t> deaths(count());
+        for (uint8_t& id : deaths) {
+            id = in.get8();
+        }
+
+        n = count();
+        for (uint32_t i = 0; i < n && in.ok(); i++) {
+            uint8_t id = in.get8();
+            int32_t head = in.getVarint();
+            uint8_t dir = in.get8() & 3;
+            uint8_t length = in.get8();
+            if (id >= snakes.size() || !validCell(head)) {
+                return false;
+            }
+            clearSnake(id);
+            int back = (dir + 2) % 4;
+            int cell = head;
+            for (int k = 0; k < length && validCell(cell); k++) {
+                placeBack(id, cell);
+                cell = step(cell, back);
+            }
+            snakes[id].alive = true;
+        }
+
+        for (uint8_t id : tails) {
+            if (id >= snakes.size() || snakes[id].body.empty()) {
+                return false;
+            }
+            int32_t tail = snakes[id].body.back();
+            snakes[id].body.pop_back();
+            if (owner[tail] == id + 1) {
+                owner[tail] = 0;
+            }
+        }
+        for (auto& h : heads) {
+            if (h.first >= snakes.size() || !validCell(h.second)) {
+                return false;
+            }
+            snakes[h.first].body.push_front(h.second);
+            owner[h.second] = h.first + 1;
+        }
+        for (uint8_t id : deaths) {
+            if (id < snakes.size()) {
+                clearSnake(id);
+            }
+        }
+
+        n = count();
+        std::vector<int32_t> added(n);
+        for (int32_t& cell : added) {
+            cell = in.getVarint();
+        }
+        n = in.getVarint();
+        for (uint32_t i = 0; i < n && in.ok(); i++) {
+            removeFood(in.getVarint());
+        }
+        for (int32_t cell : added) {
+            addFood(cell);
+        }
+
+        tick++;
+        return in.ok() && boardStateHash(snakes, food) == hash;
+    }
+
+    // Collects one KEYFRAME part; once every part of a tick has arrived the
+    // board is rebuilt from them. Returns true when the replica was replaced.
+    bool addKeyframePart(PacketReader& in)
+    {
+        uint32_t frameTick = in.get32();
+        uint8_t part = in.get8();
+        uint8_t partCount = in.get8();
+        uint32_t hash = in.get32();
+        if (!in.ok() || partCount == 0 || part >= partCount) {
+            return false;
+        }
+
+        if (frameTick != stagingTick || partCount != stagingParts.size()) {
+            stagingTick = frameTick;
+            stagingParts.assign(partCount, std::vector<uint8_t>());
+            stagingReceived = 0;
+        }
+        if (!stagingParts[part].empty()) {
+            return false;
+        }
+        std::vector<uint8_t>& bytes = stagingParts[part];
+        while (in.remaining() > 0) {
+            bytes.push_back(in.get8());
+        }
+        if (bytes.empty()) {
+            bytes.push_back(0);
+        }
+        if (++stagingReceived < partCount) {
+            return false;
+        }
+
+        reset(width, height);
+        for (std::vector<uint8_t>& partBytes : stagingParts) {
+            PacketReader pr(partBytes.data(), partBytes.size());
+            uint32_t foodCount = pr.getVarint();
+            for (uint32_t i = 0; i < foodCount && pr.ok(); i++) {
+                addFood(pr.getVarint());
+            }
+            uint32_t runs = pr.getVarint();
+            for (uint32_t r = 0; r < runs && pr.ok(); r++) {
+                uint8_t id = pr.get8();
+                uint32_t offset = pr.getVarint();
+                int32_t cell = pr.getVarint();
+                uint32_t length = pr.getVarint();
+                if (id >= snakes.size() || !validCell(cell) || snakes[id].body.size() != offset) {
+                    pr.fail();
+                    break;
+                }
+                snakes[id].alive = true;
+                placeBack(id, cell);
+                uint8_t bits = 0;
+                for (uint32_t i = 1; i < length; i++) {
+                    if ((i - 1) % 4 == 0) {
+                        bits = pr.get8();
+                    }
+                    cell = step(cell, (bits >> (((i - 1) % 4) * 2)) & 3);
+                    if (!validCell(cell)) {
+                        break;
+                    }
+                    placeBack(id, cell);
+                }
+            }
+            if (!pr.ok()) {
+                stagingParts.clear();
+                return false;
+            }
+        }
+
+        stagingParts.clear();
+        tick = frameTick;
+        synced = boardStateHash(snakes, food) == hash;
+        return synced;
+    }
+
+private:
+    std::vector<int32_t> foodSlot;
+    uint32_t stagingTick = 0;
+    std::vector<std::vector<uint8_t>> stagingParts;
+    int stagingReceived = 0;
+
+    void placeBack(int id, int32_t cell)
+    {
+        snakes[id].body.push_back(cell);
+        owner[cell] = (uint8_t)(id + 1);
+    }
+
+    void clearSnake(int id)
+    {
+        for (int32_t cell : snakes[id].body) {
+            if (owner[cell] == id + 1) {
+                owner[cell] = 0;
+            }
+        }
+        snakes[id].body.clear();
+        snakes[id].alive = false;
+    }
+
+    void addFood(uint32_t cell)
+    {
+        if (!validCell(cell) || hasFood(cell)) {
+            return;
+        }
+        foodSlot[cell] = (int32_t)food.size();
+        food.push_back(cell);
+    }
+
+    void removeFood(uint32_t cell)
+    {
+        if (!validCell(cell) || !hasFood(cell)) {
+            return;
+        }
+        int slot = foodSlot[cell];
+        food[slot] = food.back();
+        foodSlot[food[slot]] = slot;
+        food.pop_back();
+        foodSlot[cell] = -1;
+    }
+};
+
+struct NetClientStats {
+    uint64_t bytesReceived = 0;
+    uint64_t bytesSent = 0;
+    uint64_t packetsReceived = 0;
+    uint32_t resyncs = 0;
+    std::vector<uint32_t> latencyUs; // input sent -> first snapshot that applied it
+};
+
+class NetClient {
+public:
+    BoardReplica board;
+    NetClientStats stats;
+    int player = -1;
+    int hz = 0;
+
+    ~NetClient()
+    {
+        leave();
+    }
+
+    bool connect(const char* host, uint16_t port, int timeoutMs = 3000)
+    {
+        if (!socketsInit()) {
+            return false;
+        }
+        sock = socket(AF_INET, SOCK_DGRAM, 0);
+        if (sock == (socket_t)-1) {
+            std::cout << "Could not create socket" << std::endl;
+            return false;
+        }
+        setNonBlocking(sock);
+
+        memset(&server, 0, sizeof(server));
+        server.sin_family = AF_INET;
+        server.sin_port = htons(port);
+        if (inet_pton(AF_INET, host, &server.sin_addr) != 1) {
+            std::cout << "Bad server address " << host << std::endl;
+            return false;
+        }
+
+        uint32_t nonce = (uint32_t)nowMicros() ^ (uint32_t)(uintptr_t)this;
+        uint64_t start = nowMicros();
+        uint64_t lastSend = 0;
+        while (nowMicros() - start < (uint64_t)timeoutMs * 1000) {
+            if (nowMicros() - lastSend > 250000) {
+                PacketWriter w;
+                w.put8(PACKET_JOIN);
+                w.put32(nonce);
+                send(w);
+                lastSend = nowMicros();
+            }
+
+            uint8_t buf[NET_MAX_PACKET];
+            int n;
+            while ((n = receive(buf)) > 0) {
+                PacketReader in(buf, n);
+                uint8_t type = in.get8();
+                if (type == PACKET_FULL) {
+                    std::cout << "Server is full" << std::endl;
+                    return false;
+                }
+                if (type == PACKET_WELCOME && in.get32() == nonce) {
+                    player = in.get8();
+                    int w = in.get16();
+                    int h = in.get16();
+                    hz = in.get16();
+                    board.reset(w, h);
+                    requestResync();
+                    return in.ok();
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        std::cout << "No answer from server" << std::endl;
+        return false;
+    }
+
+    void sendInput(int dir)
+    {
+        PacketWriter w;
+        w.put8(PACKET_INPUT);
+        w.put8((uint8_t)player);
+        w.put32(++inputSeq);
+        w.put8((uint8_t)dir);
+        w.put64(nowMicros());
+        send(w);
+    }
+
+    void leave()
+    {
+        if (sock == (socket_t)-1) {
+            return;
+        }
+        if (player >= 0) {
+            PacketWriter w;
+            w.put8(PACKET_LEAVE);
+            w.put8((uint8_t)player);
+            send(w);
+        }
+        closeSocket(sock);
+        sock = (socket_t)-1;
+    }
+
+    // Drains every pending packet. Returns the number of ticks the replica advanced.
+    int poll()
+    {
+        int advanced = 0;
+        uint8_t buf[NET_MAX_PACKET];
+        int n;
+        while ((n = receive(buf)) > 0) {
+            stats.packetsReceived++;
+            stats.bytesReceived += n;
+            PacketReader in(buf, n);
+            uint8_t type = in.get8();
+
+            if (type == PACKET_DELTA) {
+                uint32_t tick = in.get32();
+                uint32_t ackSeq = in.get32();
+                uint64_t echoUs = in.get64();
+                if (ackSeq > lastAckSeq) {
+                    lastAckSeq = ackSeq;
+                    stats.latencyUs.push_back((uint32_t)(nowMicros() - echoUs));
+                }
+
+                if (!board.synced || tick <= board.tick) {
+                    continue;
+                }
+                if (tick != board.tick + 1 || !board.applyDelta(in)) {
+                    board.synced = false;
+                    requestResync();
+                    continue;
+                }
+                advanced++;
+            } else if (type == PACKET_KEYFRAME) {
+                uint32_t before = board.tick;
+                if (board.addKeyframePart(in)) {
+                    advanced += board.tick > before ? board.tick - before : 1;
+                }
+            }
+        }
+
+        // Keep asking until a keyframe lands, in case the request was lost.
+        if (!board.synced && nowMicros() - lastResyncUs > 200000) {
+            requestResync();
+        }
+        return advanced;
+    }
+
+    // Waits up to timeoutMs for the socket to become readable.
+    void wait(int timeoutMs)
+    {
+#ifdef _WIN32
+        fd_set set;
+        FD_ZERO(&set);
+        FD_SET(sock, &set);
+        timeval tv = {0, timeoutMs * 1000};
+        select(0, &set, nullptr, nullptr, &tv);
+#else
+        pollfd pfd = {sock, POLLIN, 0};
+        ::poll(&pfd, 1, timeoutMs);
+#endif
+    }
+
+    int mySnake() const { return player; }
+
+private:
+    socket_t sock = (socket_t)-1;
+    sockaddr_in server;
+    uint32_t inputSeq = 0;
+    uint32_t lastAckSeq = 0;
+    uint64_t lastResyncUs = 0;
+
+    void requestResync()
+    {
+        PacketWriter w;
+        w.put8(PACKET_RESYNC);
+        w.put8((uint8_t)player);
+        send(w);
+        stats.resyncs++;
+        lastResyncUs = nowMicros();
+    }
+
+    void send(const PacketWriter& w)
+    {
+        sendto(sock, (const char*)w.data, w.size, 0, (const sockaddr*)&server, sizeof(server));
+        stats.bytesSent += w.size;
+    }
+
+    // Returns the size of the next packet from the server, skipping strays.
+    int receive(uint8_t* buf)
+    {
+        while (true) {
+            sockaddr_in from;
+            socklen_t len = sizeof(from);
+            int n = recvfrom(sock, (char*)buf, NET_MAX_PACKET, 0, (sockaddr*)&from, &len);
+            if (n <= 0 || (from.sin_addr.s_addr == server.sin_addr.s_addr && from.sin_port == server.sin_port)) {
+                return n;
+            }
+        }
+    }
+};
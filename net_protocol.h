@@ -0,0 +1,232 @@
+#pragma once
+
+// Wire format shared by snake_server, snake_client and snake_bot.
+//
+// Clients send direction intents over UDP. The server answers every tick
+// with a DELTA holding only what changed since the previous tick: new
+// head cells, which snakes retired a tail cell, food added and removed,
+// deaths and spawns. A client that misses a tick asks for a KEYFRAME,
+// which carries the whole board with each body packed as 2-bit steps.
+
+#include <bits/stdc++.h>
+#include "snake_world.h"
+#include "net_socket.h"
+
+const uint16_t NET_DEFAULT_PORT = 40150;
+const int NET_MAX_PACKET = 1400;
+const int NET_MAX_PLAYERS = 250;
+const int NET_CLIENT_TIMEOUT_MS = 5000;
+const int NET_RESPAWN_TICKS = 60;
+
+enum PacketType : uint8_t {
+    PACKET_JOIN = 1,     // client -> server: nonce u32
+    PACKET_WELCOME,      // server -> client: nonce u32, player u8, width u16, height u16, hz u16
+    PACKET_INPUT,        // client -> server: player u8, seq u32, dir u8, sentUs u64
+    PACKET_RESYNC,       // client -> server: player u8
+    PACKET_LEAVE,        // client -> server: player u8
+    PACKET_DELTA,        // server -> client: see writeDeltaBody
+    PACKET_KEYFRAME,     // server -> client: see writeKeyframes
+    PACKET_FULL,         // server -> client: no free player slot
+};
+
+inline uint64_t nowMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class PacketWriter {
+public:
+    uint8_t data[NET_MAX_PACKET];
+    int size = 0;
+
+    void put8(uint8_t v) { data[size++] = v; }
+    void put16(uint16_t v) { put8(v & 0xFF); put8(v >> 8); }
+    void put32(uint32_t v) { put16(v & 0xFFFF); put16(v >> 16); }
+    void put64(uint64_t v) { put32((uint32_t)v); put32((uint32_t)(v >> 32)); }
+
+    void putVarint(uint32_t v)
+    {
+        while (v >= 0x80) {
+            put8((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        put8((uint8_t)v);
+    }
+
+    int room() const { return NET_MAX_PACKET - size; }
+};
+
+class PacketReader {
+public:
+    PacketReader(const uint8_t* data, int size) : data(data), size(size) {}
+
+    bool ok() const { return !overrun; }
+    void fail() { overrun = true; }
+    int remaining() const { return size - pos; }
+
+    uint8_t get8()
+    {
+        if (pos >= size) {
+            overrun = true;
+            return 0;
+        }
+        return data[pos++];
+    }
+    uint16_t get16() { uint16_t lo = get8(); return lo | (uint16_t)get8() << 8; }
+    uint32_t get32() { uint32_t lo = get16(); return lo | (uint32_t)get16() << 16; }
+    uint64_t get64() { uint64_t lo = get32(); return lo | (uint64_t)get32() << 32; }
+
+    uint32_t getVarint()
+    {
+        uint32_t v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            uint8_t b = get8();
+            v |= (uint32_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                break;
+            }
+        }
+        return v;
+    }
+
+private:
+    const uint8_t* data;
+    int size;
+    int pos = 0;
+    bool overrun = false;
+};
+
+// DELTA layout, after the per-client header (type, tick, ackSeq, echoUs):
+//   hash u32
+//   heads:   count varint, then (snake u8, cell varint)*
+//   tails:   count varint, then snake u8*
+//   deaths:  count varint, then snake u8*
+//   spawns:  count varint, then (snake u8, head varint, dir u8, length u8)*
+//   foodAdd: count varint, then cell varint*
+//   foodDel: count varint, then cell varint*
+// Returns false if the delta does not fit in one packet.
+inline bool writeDeltaBody(PacketWriter& out, const WorldDelta& d, uint32_t hash)
+{
+    // Worst case per entry is 1 + 5 bytes; bail out early rather than overflow.
+    size_t worst = 4 + 6 * 5 + d.heads.size() * 6 + d.tails.size() + d.deaths.size() +
+                   d.spawns.size() * 8 + (d.foodAdded.size() + d.foodRemoved.size()) * 5;
+    if ((int)worst > out.room()) {
+        return false;
+    }
+
+    out.put32(hash);
+    out.putVarint(d.heads.size());
+    for (auto& h : d.heads) {
+        out.put8((uint8_t)h.first);
+        out.putVarint(h.second);
+    }
+    out.putVarint(d.tails.size());
+    for (uint16_t id : d.tails) {
+        out.put8((uint8_t)id);
+    }
+    out.putVarint(d.deaths.size());
+    for (uint16_t id : d.deaths) {
+        out.put8((uint8_t)id);
+    }
+    out.putVarint(d.spawns.size());
+    for (const WorldSpawn& s : d.spawns) {
+        out.put8((uint8_t)s.id);
+        out.putVarint(s.head);
+        out.put8(s.dir);
+        out.put8((uint8_t)s.length);
+    }
+    out.putVarint(d.foodAdded.size());
+    for (int32_t cell : d.foodAdded) {
+        out.putVarint(cell);
+    }
+    out.putVarint(d.foodRemoved.size());
+    for (int32_t cell : d.foodRemoved) {
+        out.putVarint(cell);
+    }
+    return true;
+}
+
+// Splits the whole board into KEYFRAME packets:
+//   type, tick u32, part u8, partCount u8, hash u32
+//   food: count varint, cell varint* (a long list spills into later parts)
+//   runs: count varint, then (snake u8, offset varint, cell varint, length varint, 2-bit steps)*
+// Each run is a stretch of one body starting at its offset from the head;
+// long bodies are split into several runs so any run fits in a packet.
+const int KEYFRAME_RUN_CELLS = 2048;
+
+inline std::vector<PacketWriter> writeKeyframes(const SnakeWorld& world)
+{
+    std::vector<std::vector<uint8_t>> runs;
+    for (size_t id = 0; id < world.snakes.size(); id++) {
+        const WorldSnake& s = world.snakes[id];
+        if (!s.alive) {
+            continue;
+        }
+        for (size_t offset = 0; offset < s.body.size(); offset += KEYFRAME_RUN_CELLS) {
+            size_t length = std::min<size_t>(KEYFRAME_RUN_CELLS, s.body.size() - offset);
+            PacketWriter w;
+            w.put8((uint8_t)id);
+            w.putVarint(offset);
+            w.putVarint(s.body[offset]);
+            w.putVarint(length);
+            uint8_t bits = 0;
+            int used = 0;
+            for (size_t i = offset + 1; i < offset + length; i++) {
+                int from = s.body[i - 1], to = s.body[i];
+                int dir = to == from - world.width ? DIR_UP : to == from + 1 ? DIR_RIGHT :
+                          to == from + world.width ? DIR_DOWN : DIR_LEFT;
+                bits |= dir << (used * 2);
+                if (++used == 4) {
+                    w.put8(bits);
+                    bits = 0;
+                    used = 0;
+                }
+            }
+            if (used) {
+                w.put8(bits);
+            }
+            runs.emplace_back(w.data, w.data + w.size);
+        }
+    }
+
+    std::vector<PacketWriter> parts;
+    uint32_t hash = world.stateHash();
+    size_t foodSent = 0;
+    size_t next = 0;
+    do {
+        PacketWriter w;
+        w.put8(PACKET_KEYFRAME);
+        w.put32(world.tick);
+        w.put8((uint8_t)parts.size());
+        w.put8(0); // part count, patched below
+        w.put32(hash);
+
+        // Food goes first and may itself spill over several parts.
+        size_t foodHere = std::min<size_t>(world.food.size() - foodSent, (w.room() - 8) / 5);
+        w.putVarint(foodHere);
+        for (size_t i = 0; i < foodHere; i++) {
+            w.putVarint(world.food[foodSent + i]);
+        }
+        foodSent += foodHere;
+
+        size_t first = next;
+        int bytes = 0;
+        while (foodSent == world.food.size() && next < runs.size() &&
+               bytes + (int)runs[next].size() + 3 <= w.room()) {
+            bytes += runs[next].size();
+            next++;
+        }
+        w.putVarint(next - first);
+        for (size_t i = first; i < next; i++) {
+            memcpy(w.data + w.size, runs[i].data(), runs[i].size());
+            w.size += runs[i].size();
+        }
+        parts.push_back(w);
+    } while (foodSent < world.food.size() || next < runs.size());
+
+    for (PacketWriter& w : parts) {
+        w.data[6] = (uint8_t)parts.size();
+    }
+    return parts;
+}
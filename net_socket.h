@@ -0,0 +1,27 @@
+#pragma once
+
+// The few socket calls that differ between Winsock and POSIX, for the
+// multiplayer programs and the score sync client.
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    typedef SOCKET socket_t;
+    inline void closeSocket(socket_t s) { closesocket(s); }
+    inline bool setNonBlocking(socket_t s) { u_long on = 1; return ioctlsocket(s, FIONBIO, &on) == 0; }
+    inline bool setBlocking(socket_t s) { u_long off = 0; return ioctlsocket(s, FIONBIO, &off) == 0; }
+    inline bool socketsInit() { WSADATA data; return WSAStartup(MAKEWORD(2, 2), &data) == 0; }
+#else
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+    typedef int socket_t;
+    inline void closeSocket(socket_t s) { close(s); }
+    inline bool setNonBlocking(socket_t s) { return fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) == 0; }
+    inline bool setBlocking(socket_t s) { return fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) & ~O_NONBLOCK) == 0; }
+    inline bool socketsInit() { return true; }
+#endif
@@ -0,0 +1,189 @@
+#pragma once
+
+// Batched sprite drawing. All game sprites live in one atlas texture
+// (apple, snake head, body circle, a plain white cell for walls and the
+// glyphs of the score line), and a frame's sprites are gathered into one
+// reusable vertex/index buffer that is submitted with a single
+// SDL_RenderGeometry call, however long the snake is.
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_ttf.h>
+#include <bits/stdc++.h>
+
+const int ATLAS_SLOT_SIZE = 64;
+const int ATLAS_WIDTH = 256;
+const int ATLAS_HEIGHT = 160; // sprite row plus up to three rows of glyphs
+const char* const ATLAS_GLYPHS = "Score: 0123456789-.tikpfamusynwdq"; // score line, the F3 latency line and task301's key hints
+
+enum Sprite {
+    SPRITE_APPLE = 0,
+    SPRITE_HEAD,
+    SPRITE_BODY,
+    SPRITE_SOLID,
+    SPRITE_COUNT,
+};
+
+// Where each character of ATLAS_GLYPHS sits in the atlas; w == 0 if absent.
+struct AtlasGlyphs {
+    SDL_Rect rects[128] = {};
+};
+
+// Rasterizes ATLAS_GLYPHS once, left to right below the sprite row.
+inline void addAtlasGlyphs(SDL_Surface* atlas, TTF_Font* font, AtlasGlyphs& glyphs)
+{
+    SDL_Color white = {255, 255, 255, 255};
+    int x = 0, y = ATLAS_SLOT_SIZE;
+    for (const char* c = ATLAS_GLYPHS; *c; c++) {
+        char text[2] = {*c, 0};
+        SDL_Surface* glyph = TTF_RenderText_Solid(font, text, white);
+        if (!glyph) {
+            continue;
+        }
+        if (x + glyph->w > ATLAS_WIDTH) {
+            x = 0;
+            y += glyph->h;
+        }
+        if (y + glyph->h <= ATLAS_HEIGHT) {
+            SDL_Rect slot = {x, y, glyph->w, glyph->h};
+            SDL_BlitSurface(glyph, nullptr, atlas, &slot);
+            glyphs.rects[(unsigned char)*c] = slot;
+            x += glyph->w;
+        } else {
+            std::cout << "Sprite atlas has no room for glyph '" << *c << "'" << std::endl;
+        }
+        SDL_FreeSurface(glyph);
+    }
+}
+
+// Loads the sprite images into one RGBA surface, one 64x64 slot each, with
+// the score glyphs underneath.
+inline SDL_Texture* buildSpriteAtlas(SDL_Renderer* renderer, TTF_Font* font, AtlasGlyphs& glyphs)
+{
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_WIDTH, ATLAS_HEIGHT, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!atlas) {
+        std::cout << "Failed to create sprite atlas: " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+    SDL_FillRect(atlas, nullptr, SDL_MapRGBA(atlas->format, 0, 0, 0, 0));
+
+    const char* images[] = {"image/apple.png", "image/snake_head.png"};
+    for (int i = 0; i < 2; i++) {
+        SDL_Surface* image = IMG_Load(images[i]);
+        if (!image) {
+            std::cout << "Failed to load " << images[i] << ": " << IMG_GetError() << std::endl;
+            SDL_FreeSurface(atlas);
+            return nullptr;
+        }
+        SDL_SetSurfaceBlendMode(image, SDL_BLENDMODE_NONE);
+        SDL_Rect slot = {i * ATLAS_SLOT_SIZE, 0, ATLAS_SLOT_SIZE, ATLAS_SLOT_SIZE};
+        SDL_BlitScaled(image, nullptr, atlas, &slot);
+        SDL_FreeSurface(image);
+    }
+
+    // Body segment: a white disc, tinted per vertex when drawn.
+    Uint32 white = SDL_MapRGBA(atlas->format, 255, 255, 255, 255);
+    Uint32* pixels = static_cast<Uint32*>(atlas->pixels);
+    int stride = atlas->pitch / 4;
+    int radius = ATLAS_SLOT_SIZE / 2;
+    for (int y = 0; y < ATLAS_SLOT_SIZE; y++) {
+        for (int x = 0; x < ATLAS_SLOT_SIZE; x++) {
+            int cx = x - radius, cy = y - radius;
+            if (cx * cx + cy * cy <= radius * radius) {
+                pixels[y * stride + SPRITE_BODY * ATLAS_SLOT_SIZE + x] = white;
+            }
+        }
+    }
+
+    SDL_Rect solid = {SPRITE_SOLID * ATLAS_SLOT_SIZE, 0, ATLAS_SLOT_SIZE, ATLAS_SLOT_SIZE};
+    SDL_FillRect(atlas, &solid, white);
+
+    addAtlasGlyphs(atlas, font, glyphs);
+
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, atlas);
+    SDL_FreeSurface(atlas);
+    if (!texture) {
+        std::cout << "Failed to create sprite atlas texture: " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    return texture;
+}
+
+class RenderQueue {
+public:
+    void clear()
+    {
+        vertices.clear();
+        indices.clear();
+    }
+
+    // Grows the buffers up front, including SDL's own vertex buffer, so
+    // frames of up to this many sprites never allocate.
+    void reserve(SDL_Renderer* renderer, SDL_Texture* atlas, size_t sprites)
+    {
+        vertices.reserve(sprites * 4);
+        indices.reserve(sprites * 6);
+        clear();
+        for (size_t i = 0; i < sprites; i++) {
+            add(SPRITE_SOLID, {0, 0, 0, 0});
+        }
+        submit(renderer, atlas);
+        clear();
+    }
+
+    void add(Sprite sprite, const SDL_Rect& rect, SDL_Color color = {255, 255, 255, 255})
+    {
+        SDL_Rect slot = {sprite * ATLAS_SLOT_SIZE, 0, ATLAS_SLOT_SIZE, ATLAS_SLOT_SIZE};
+        addRegion(slot, rect, color);
+    }
+
+    // Draws text from the atlas glyphs; characters not in ATLAS_GLYPHS are skipped.
+    void addText(const AtlasGlyphs& glyphs, const char* text, int x, int y, SDL_Color color = {255, 255, 255, 255})
+    {
+        for (const char* c = text; *c; c++) {
+            const SDL_Rect& g = glyphs.rects[(unsigned char)*c & 127];
+            if (g.w > 0) {
+                addRegion(g, {x, y, g.w, g.h}, color);
+                x += g.w;
+            }
+        }
+    }
+
+    void addRegion(const SDL_Rect& source, const SDL_Rect& rect, SDL_Color color)
+    {
+        // Sample half a texel inside the region so neighbours never bleed in.
+        float u0 = (source.x + 0.5f) / ATLAS_WIDTH;
+        float u1 = (source.x + source.w - 0.5f) / ATLAS_WIDTH;
+        float v0 = (source.y + 0.5f) / ATLAS_HEIGHT;
+        float v1 = (source.y + source.h - 0.5f) / ATLAS_HEIGHT;
+
+        float x0 = (float)rect.x, y0 = (float)rect.y;
+        float x1 = (float)(rect.x + rect.w), y1 = (float)(rect.y + rect.h);
+
+        int base = (int)vertices.size();
+        vertices.push_back({{x0, y0}, color, {u0, v0}});
+        vertices.push_back({{x1, y0}, color, {u1, v0}});
+        vertices.push_back({{x1, y1}, color, {u1, v1}});
+        vertices.push_back({{x0, y1}, color, {u0, v1}});
+
+        indices.push_back(base);
+        indices.push_back(base + 1);
+        indices.push_back(base + 2);
+        indices.push_back(base);
+        indices.push_back(base + 2);
+        indices.push_back(base + 3);
+    }
+
+    void submit(SDL_Renderer* renderer, SDL_Texture* atlas)
+    {
+        if (!indices.empty()) {
+            SDL_RenderGeometry(renderer, atlas, vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size());
+        }
+    }
+
+private:
+    // Kept between frames so steady-state frames do not allocate.
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+};
@@ -0,0 +1,238 @@
+#pragma once
+
+// Game recordings. The simulation thread appends one small fixed-size
+// frame per tick (head, food, bonus, length, score and the input of that
+// tick) to a buffer the game hands in up front; the body is not stored
+// because it is always the last `length` head positions. With the game's
+// seed in the header, a version 2 recording can also be re-simulated
+// from its inputs. The recording is written to replays/ when the game
+// ends and can be played back headlessly, e.g. by replay_export.
+
+#include <bits/stdc++.h>
+#include "crc32.h"
+
+const uint32_t REPLAY_MAGIC = 0x50524E53; // "SNRP"
+const uint32_t REPLAY_VERSION = 2; // 1 had no seed and no inputs
+const char* const REPLAY_DIR = "replays";
+const size_t REPLAY_MAX_FRAMES = 1 << 15; // over an hour at 120 ms a tick
+
+enum ReplayLayout : uint16_t {
+    LAYOUT_CLASSIC = 0, // main
+    LAYOUT_MAZE,        // task301, with the inner walls
+};
+
+enum ReplayFrameFlags : uint8_t {
+    REPLAY_MOVED = 1, // head was pushed this tick (not paused)
+    REPLAY_BONUS = 2, // bonus food on the board
+};
+
+struct ReplayHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint16_t screenWidth, screenHeight;
+    uint16_t cellSize, tickMs;
+    uint16_t layout;
+    uint16_t reserved;
+    uint32_t frameCount;
+    int64_t startTime;
+    uint64_t seed; // not in version 1
+};
+
+struct ReplayFrame {
+    int16_t headX, headY;
+    int16_t foodX, foodY;
+    int16_t bonusX, bonusY;
+    uint16_t length;
+    uint8_t flags;
+    uint8_t input; // see replayInput
+    int32_t score;
+};
+
+// The input that produced a frame: the packed direction (dx + 1) * 3 +
+// dy + 1 in cells, and continue presses above it.
+inline uint8_t replayInput(int packedDirection, int continues)
+{
+    return (uint8_t)(std::min(continues, 15) << 4 | packedDirection);
+}
+
+inline int replayDirection(uint8_t input)
+{
+    return input & 15;
+}
+
+inline int replayContinues(uint8_t input)
+{
+    return input >> 4;
+}
+
+struct ReplayPoint {
+    int x, y;
+};
+
+class ReplayRecorder {
+public:
+    void begin(ReplayLayout layout, int screenWidth, int screenHeight, int cellSize, int tickMs, uint64_t seed, ReplayFrame* storage,
+               size_t capacity)
+    {
+        header = {};
+        header.magic = REPLAY_MAGIC;
+        header.version = REPLAY_VERSION;
+        header.screenWidth = (uint16_t)screenWidth;
+        header.screenHeight = (uint16_t)screenHeight;
+        header.cellSize = (uint16_t)cellSize;
+        header.tickMs = (uint16_t)tickMs;
+        header.layout = layout;
+        header.startTime = (int64_t)time(nullptr);
+        header.seed = seed;
+        frames = storage;
+        frameCapacity = capacity;
+        frameCount = 0;
+        dropped = 0;
+    }
+
+    // Segment is each game's own {x, y} struct; Body indexes like a vector.
+    template <class Body, class Segment>
+    void record(const Body& snake, const Segment& food, const Segment& bonus, bool bonusActive, int score, uint8_t input = 0)
+    {
+        if (frameCount == frameCapacity) {
+            dropped++;
+            return;
+        }
+
+        ReplayFrame f = {};
+        f.headX = (int16_t)snake[0].x;
+        f.headY = (int16_t)snake[0].y;
+        f.foodX = (int16_t)food.x;
+        f.foodY = (int16_t)food.y;
+        f.bonusX = (int16_t)bonus.x;
+        f.bonusY = (int16_t)bonus.y;
+        f.length = (uint16_t)snake.size();
+        f.score = score;
+        f.input = input;
+        f.flags = bonusActive ? REPLAY_BONUS : 0;
+        if (frameCount == 0 || frames[frameCount - 1].headX != f.headX || frames[frameCount - 1].headY != f.headY) {
+            f.flags |= REPLAY_MOVED;
+        }
+        frames[frameCount++] = f;
+    }
+
+    // Writes <dir>/<start time>-<n>.replay and returns its path, or an
+    // empty string if nothing could be written.
+    std::string save(const std::string& dir = REPLAY_DIR)
+    {
+        static std::atomic<int> saved{0};
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        std::string path = dir + "/" + std::to_string(header.startTime) + "-" + std::to_string(++saved) + ".replay";
+
+        header.frameCount = (uint32_t)frameCount;
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(frames), frameCount * sizeof(ReplayFrame));
+        if (!file) {
+            std::cout << "Error: Could not write replay " << path << std::endl;
+            return "";
+        }
+        if (dropped > 0) {
+            std::cout << "Replay " << path << " is missing the last " << dropped << " ticks" << std::endl;
+        }
+        return path;
+    }
+
+    // CRC-32 of the file save() writes, to tie a reported score to its
+    // recording.
+    uint32_t hash() const
+    {
+        ReplayHeader saved = header;
+        saved.frameCount = (uint32_t)frameCount;
+        return crc32(frames, frameCount * sizeof(ReplayFrame), crc32(&saved, sizeof(saved)));
+    }
+
+private:
+    ReplayHeader header = {};
+    ReplayFrame* frames = nullptr;
+    size_t frameCapacity = 0;
+    size_t frameCount = 0;
+    size_t dropped = 0;
+};
+
+struct ReplayState {
+    std::vector<ReplayPoint> snake; // head first
+    ReplayPoint food;
+    ReplayPoint bonus;
+    bool bonusActive;
+    int score;
+};
+
+class ReplayPlayer {
+public:
+    ReplayHeader header = {};
+    std::vector<ReplayFrame> frames;
+
+    bool load(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        header = {};
+        if (!file.read(reinterpret_cast<char*>(&header), offsetof(ReplayHeader, seed))) {
+            std::cout << "Error: Could not read replay " << path << std::endl;
+            return false;
+        }
+        if (header.magic != REPLAY_MAGIC || header.version < 1 || header.version > REPLAY_VERSION) {
+            std::cout << "Error: " << path << " is not a version 1-" << REPLAY_VERSION << " replay" << std::endl;
+            return false;
+        }
+        if (header.version >= 2 && !file.read(reinterpret_cast<char*>(&header.seed), sizeof(header.seed))) {
+            std::cout << "Error: Replay " << path << " is truncated" << std::endl;
+            return false;
+        }
+        frames.resize(header.frameCount);
+        if (!file.read(reinterpret_cast<char*>(frames.data()), frames.size() * sizeof(ReplayFrame))) {
+            std::cout << "Error: Replay " << path << " is truncated" << std::endl;
+            return false;
+        }
+        rewind();
+        return true;
+    }
+
+    void rewind()
+    {
+        next = 0;
+        heads.clear();
+    }
+
+    size_t position() const
+    {
+        return next;
+    }
+
+    double durationSeconds() const
+    {
+        return frames.size() * header.tickMs / 1000.0;
+    }
+
+    // Applies the next frame to state; false once the recording is over.
+    bool step(ReplayState& state)
+    {
+        if (next >= frames.size()) {
+            return false;
+        }
+        const ReplayFrame& f = frames[next++];
+        if (f.flags & REPLAY_MOVED) {
+            heads.push_front({f.headX, f.headY});
+        }
+        while (heads.size() > std::max<size_t>(f.length, 1)) {
+            heads.pop_back();
+        }
+
+        state.snake.assign(heads.begin(), heads.end());
+        state.food = {f.foodX, f.foodY};
+        state.bonus = {f.bonusX, f.bonusY};
+        state.bonusActive = (f.flags & REPLAY_BONUS) != 0;
+        state.score = f.score;
+        return true;
+    }
+
+private:
+    size_t next = 0;
+    std::deque<ReplayPoint> heads;
+};
@@ -0,0 +1,240 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <bits/stdc++.h>
+#include "replay.h"
+#include "soft_render.h"
+#include "image_io.h"
+
+using namespace std;
+
+// Headless replay exporter.
+//   replay_export <file.replay> [--png DIR | --y4m FILE | --null] [--fps N] [--threads N]
+// The replay is stepped on the main thread, which runs up to two frames
+// per worker ahead of the encoders; workers draw the scene into their own
+// software framebuffer and encode it, and the main thread writes the
+// finished frames out in order. --null skips the output to time the
+// pipeline alone. SDL_image is only used to load the two sprite images.
+
+struct SceneSprites {
+    SoftSprite apple, bonus, head, body;
+};
+
+struct FrameSlot {
+    ReplayState state;
+    vector<uint8_t> encoded;
+    bool done = false;
+};
+
+enum OutputKind { OUTPUT_PNG, OUTPUT_Y4M, OUTPUT_NULL };
+
+SoftSprite loadSprite(const char* path, int size, uint8_t r, uint8_t g, uint8_t b)
+{
+    SDL_Surface* image = IMG_Load(path);
+    SDL_Surface* rgba = image ? SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+    if (image) {
+        SDL_FreeSurface(image);
+    }
+    if (!rgba) {
+        cout << "Could not load " << path << ", drawing a plain disc instead" << endl;
+        return makeDisc(size, r, g, b);
+    }
+
+    SDL_LockSurface(rgba);
+    SoftSprite sprite = makeSprite(static_cast<const uint8_t*>(rgba->pixels), rgba->w, rgba->h, rgba->pitch, size, size);
+    SDL_UnlockSurface(rgba);
+    SDL_FreeSurface(rgba);
+    return sprite;
+}
+
+// Same scene as renderGame in main.cpp / task301.cpp.
+void drawScene(Framebuffer& fb, const ReplayState& state, const ReplayHeader& header, const SceneSprites& sprites)
+{
+    int w = header.screenWidth, h = header.screenHeight, cell = header.cellSize;
+    fb.clear(0, 0, 0);
+
+    fb.fillRect(0, 0, w, cell, 0, 0, 255);
+    fb.fillRect(0, h - cell, w, cell, 0, 0, 255);
+    fb.fillRect(0, 0, cell, h, 0, 0, 255);
+    fb.fillRect(w - cell, 0, cell, h, 0, 0, 255);
+    if (header.layout == LAYOUT_MAZE) {
+        fb.fillRect(500, 80, 100, cell, 0, 0, 255);
+        fb.fillRect(580, 80, cell, 300, 0, 0, 255);
+        fb.fillRect(100, 80, cell, 300, 0, 0, 255);
+        fb.fillRect(100, 380, 80, cell, 0, 0, 255);
+    }
+
+    fb.blit(sprites.apple, state.food.x, state.food.y);
+    if (state.bonusActive) {
+        fb.blit(sprites.bonus, state.bonus.x, state.bonus.y);
+    }
+
+    if (!state.snake.empty()) {
+        fb.blit(sprites.head, state.snake[0].x, state.snake[0].y);
+    }
+    for (size_t i = 1; i < state.snake.size(); i++) {
+        fb.blit(sprites.body, state.snake[i].x, state.snake[i].y);
+    }
+
+    fb.drawText("Score: " + to_string(state.score), 500, 2, 2, 255, 255, 255);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        cout << "usage: replay_export <file.replay> [--png DIR | --y4m FILE | --null] [--fps N] [--threads N]" << endl;
+        return 1;
+    }
+    string input = argv[1];
+    OutputKind kind = OUTPUT_Y4M;
+    string output = "replay.y4m";
+    int fps = 30;
+    int threads = max(1u, thread::hardware_concurrency());
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--null") {
+            kind = OUTPUT_NULL;
+        } else if (i + 1 >= argc) {
+            cout << "Missing value for " << arg << endl;
+            return 1;
+        } else if (arg == "--png") {
+            kind = OUTPUT_PNG;
+            output = argv[++i];
+        } else if (arg == "--y4m") {
+            kind = OUTPUT_Y4M;
+            output = argv[++i];
+        } else if (arg == "--fps") {
+            fps = max(1, atoi(argv[++i]));
+        } else if (arg == "--threads") {
+            threads = max(1, atoi(argv[++i]));
+        } else {
+            cout << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    ReplayPlayer replay;
+    if (!replay.load(input)) {
+        return 1;
+    }
+    const ReplayHeader& header = replay.header;
+    int cell = header.cellSize;
+
+    IMG_Init(IMG_INIT_PNG);
+    SceneSprites sprites;
+    sprites.apple = loadSprite("image/apple.png", cell, 255, 0, 0);
+    sprites.bonus = loadSprite("image/apple.png", cell * 2, 255, 0, 0);
+    sprites.head = loadSprite("image/snake_head.png", cell, 0, 200, 0);
+    sprites.body = makeDisc(cell, 0, 255, 0);
+    IMG_Quit();
+
+    ofstream video;
+    if (kind == OUTPUT_Y4M) {
+        video.open(output, ios::binary);
+        string head = y4mHeader(header.screenWidth, header.screenHeight, fps);
+        video.write(head.data(), head.size());
+    } else if (kind == OUTPUT_PNG) {
+        error_code ec;
+        filesystem::create_directories(output, ec);
+    }
+    if (kind == OUTPUT_Y4M && !video) {
+        cout << "Error: Could not open " << output << endl;
+        return 1;
+    }
+
+    uint32_t totalFrames = (uint32_t)ceil(replay.durationSeconds() * fps);
+    size_t window = threads * 2;
+    vector<FrameSlot> slots(window);
+    mutex lock;
+    condition_variable changed;
+    deque<uint32_t> queue;
+    bool closing = false;
+
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&] {
+            Framebuffer fb(header.screenWidth, header.screenHeight);
+            vector<uint8_t> scratch;
+            while (true) {
+                uint32_t index;
+                {
+                    unique_lock<mutex> guard(lock);
+                    changed.wait(guard, [&] { return !queue.empty() || closing; });
+                    if (queue.empty()) {
+                        return;
+                    }
+                    index = queue.front();
+                    queue.pop_front();
+                }
+
+                FrameSlot& slot = slots[index % window];
+                drawScene(fb, slot.state, header, sprites);
+                if (kind == OUTPUT_PNG) {
+                    encodePng(fb.rgba.data(), fb.width, fb.height, slot.encoded, scratch);
+                } else {
+                    encodeY4mFrame(fb.rgba.data(), fb.width, fb.height, slot.encoded);
+                }
+
+                lock_guard<mutex> guard(lock);
+                slot.done = true;
+                changed.notify_all();
+            }
+        });
+    }
+
+    uint64_t bytesWritten = 0;
+    uint32_t written = 0;
+    auto writeOldest = [&] {
+        FrameSlot& slot = slots[written % window];
+        {
+            unique_lock<mutex> guard(lock);
+            changed.wait(guard, [&] { return slot.done; });
+        }
+        if (kind == OUTPUT_Y4M) {
+            video.write(reinterpret_cast<const char*>(slot.encoded.data()), slot.encoded.size());
+        } else if (kind == OUTPUT_PNG) {
+            char name[32];
+            snprintf(name, sizeof(name), "/frame_%06u.png", written);
+            ofstream file(output + name, ios::binary);
+            file.write(reinterpret_cast<const char*>(slot.encoded.data()), slot.encoded.size());
+        }
+        bytesWritten += slot.encoded.size();
+        slot.done = false;
+        written++;
+    };
+
+    auto start = chrono::steady_clock::now();
+    ReplayState state = {};
+    for (uint32_t i = 0; i < totalFrames; i++) {
+        // Show the tick that is current at this frame's timestamp.
+        uint64_t tick = (uint64_t)i * 1000 / ((uint64_t)fps * header.tickMs);
+        while (replay.position() <= tick && replay.step(state)) {
+        }
+
+        if (i >= window) {
+            writeOldest();
+        }
+        slots[i % window].state = state;
+        lock_guard<mutex> guard(lock);
+        queue.push_back(i);
+        changed.notify_one();
+    }
+    while (written < totalFrames) {
+        writeOldest();
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        closing = true;
+        changed.notify_all();
+    }
+    for (thread& t : workers) {
+        t.join();
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    double videoSeconds = (double)totalFrames / fps;
+    cout << fixed << setprecision(1) << "Exported " << totalFrames << " frames (" << videoSeconds << " s at " << fps
+         << " fps) with " << threads << " workers in " << seconds << " s: " << totalFrames / seconds << " frames/s, "
+         << videoSeconds / seconds << "x real time, " << bytesWritten / (1024.0 * 1024.0) << " MiB" << endl;
+    return 0;
+}
@@ -0,0 +1,350 @@
+#include <bits/stdc++.h>
+#include "snake_core.h"
+#include "replay.h"
+#include "mapped_file.h"
+#include "image_io.h"
+
+using namespace std;
+
+// Aggregate analytics over recorded games.
+//   replay_stats DIR... [--out DIR] [--threads N]
+// Every version 2 replay under the given directories is mapped and
+// re-simulated on SnakeCore from its seed and inputs, so the statistics
+// come from the core's own events rather than from the recorded frames.
+// Workers claim files one at a time and fill their own accumulators, which
+// are merged once at the end. Written to --out (default replay-stats/):
+//   heatmap-classic.png, heatmap-maze.png  head visits per cell, log scale
+//   summary.csv     games, deaths by cause, food and bonus totals per layout
+//   food-time.csv   ticks moved from a food appearing to it being eaten
+// Version 1 replays (no seed) and games on other boards are skipped; a
+// game that stops matching its recorded heads is counted as diverged and
+// left out.
+
+const int STATS_WIDTH = 640;
+const int STATS_HEIGHT = 480;
+const int STATS_CELL = 20;
+const int BONUS_FOOD_MS = 4000; // as main and task301
+const int FOOD_TIME_BUCKETS = 1000; // the last one holds everything longer
+const char* const LAYOUT_NAMES[] = {"classic", "maze"};
+
+struct LayoutStats {
+    uint64_t games = 0, ticks = 0, diverged = 0, unfinished = 0;
+    uint64_t deaths[CAUSE_MAZE_WALL + 1] = {};
+    uint64_t foodEaten = 0, bonusSpawned = 0, bonusEaten = 0, bonusExpired = 0;
+    vector<uint64_t> visits;    // head entries per cell
+    vector<uint64_t> foodTicks; // games' food-to-eat times
+
+    LayoutStats() : visits((STATS_WIDTH / STATS_CELL) * (STATS_HEIGHT / STATS_CELL)), foodTicks(FOOD_TIME_BUCKETS) {}
+
+    void merge(const LayoutStats& o)
+    {
+        games += o.games;
+        ticks += o.ticks;
+        diverged += o.diverged;
+        unfinished += o.unfinished;
+        for (int i = 0; i <= CAUSE_MAZE_WALL; i++) {
+            deaths[i] += o.deaths[i];
+        }
+        foodEaten += o.foodEaten;
+        bonusSpawned += o.bonusSpawned;
+        bonusEaten += o.bonusEaten;
+        bonusExpired += o.bonusExpired;
+        for (size_t i = 0; i < visits.size(); i++) {
+            visits[i] += o.visits[i];
+        }
+        for (size_t i = 0; i < foodTicks.size(); i++) {
+            foodTicks[i] += o.foodTicks[i];
+        }
+    }
+
+    // Food-to-eat time below which fraction of the foods were eaten.
+    int foodPercentile(double fraction) const
+    {
+        uint64_t seen = 0;
+        for (int i = 0; i < FOOD_TIME_BUCKETS; i++) {
+            seen += foodTicks[i];
+            if (seen > 0 && seen >= fraction * foodEaten) {
+                return i;
+            }
+        }
+        return 0;
+    }
+};
+
+// What one game added to a layout, kept apart until the game is known to
+// have re-simulated cleanly.
+struct GameStats {
+    uint64_t deaths[CAUSE_MAZE_WALL + 1] = {};
+    uint64_t bonusSpawned = 0, bonusEaten = 0, bonusExpired = 0;
+    bool finished = false;
+    vector<uint16_t> cells;     // head cell of every tick moved
+    vector<uint16_t> foodTimes;
+
+    // Keeps the vectors' memory for the next game.
+    void clear()
+    {
+        fill(begin(deaths), end(deaths), 0);
+        bonusSpawned = bonusEaten = bonusExpired = 0;
+        finished = false;
+        cells.clear();
+        foodTimes.clear();
+    }
+};
+
+enum GameResult { GAME_OK, GAME_SKIPPED, GAME_DIVERGED };
+
+GameResult analyse(const uint8_t* bytes, size_t size, Arena& arena, GameStats& game, int& layout)
+{
+    ReplayHeader header;
+    if (size < sizeof(header)) {
+        return GAME_SKIPPED;
+    }
+    memcpy(&header, bytes, sizeof(header));
+    if (header.magic != REPLAY_MAGIC || header.version != REPLAY_VERSION || header.layout > LAYOUT_MAZE ||
+        header.screenWidth != STATS_WIDTH || header.screenHeight != STATS_HEIGHT || header.cellSize != STATS_CELL ||
+        header.tickMs == 0 || header.frameCount == 0 || header.frameCount > (size - sizeof(header)) / sizeof(ReplayFrame)) {
+        return GAME_SKIPPED;
+    }
+    layout = header.layout;
+    bool maze = header.layout == LAYOUT_MAZE;
+    CoreRules rules = {STATS_WIDTH, STATS_HEIGHT, STATS_CELL, maze ? 2 : 5, BONUS_FOOD_MS / header.tickMs, maze};
+    int cols = STATS_WIDTH / STATS_CELL;
+
+    arena.reset();
+    SnakeCore core(arena, rules, header.seed);
+    game.clear();
+    uint32_t foodSince = 0;
+    const uint8_t* frames = bytes + sizeof(header);
+
+    // Frame 0 is the starting position; every later frame holds the input
+    // of the tick that produced it.
+    for (size_t f = 1; f < header.frameCount && !core.over(); f++) {
+        ReplayFrame recorded;
+        memcpy(&recorded, frames + f * sizeof(ReplayFrame), sizeof(recorded));
+        int packed = replayDirection(recorded.input);
+        if (packed > 8) {
+            return GAME_SKIPPED; // damaged; no game records a move of more than a cell
+        }
+        core.tick((packed / 3 - 1) * STATS_CELL, (packed % 3 - 1) * STATS_CELL, replayContinues(recorded.input));
+        const Segment& head = core.body()[0];
+        if (head.x != recorded.headX || head.y != recorded.headY) {
+            return GAME_DIVERGED;
+        }
+        if (!core.moved()) {
+            continue;
+        }
+        game.cells.push_back((uint16_t)(head.y / STATS_CELL * cols + head.x / STATS_CELL));
+
+        for (int i = 0; i < core.eventCount(); i++) {
+            const CoreEvent& e = core.events()[i];
+            switch (e.type) {
+                case EVENT_FOOD_EATEN:
+                    game.foodTimes.push_back((uint16_t)min<uint32_t>(core.ticksMoved() - foodSince, FOOD_TIME_BUCKETS - 1));
+                    foodSince = core.ticksMoved();
+                    break;
+                case EVENT_BONUS_SPAWN:
+                    game.bonusSpawned++;
+                    break;
+                case EVENT_BONUS_EATEN:
+                    game.bonusEaten++;
+                    break;
+                case EVENT_BONUS_EXPIRE:
+                    game.bonusExpired++;
+                    break;
+                case EVENT_DEATH:
+                    game.deaths[min<int>(e.cause, CAUSE_MAZE_WALL)]++;
+                    break;
+            }
+        }
+    }
+    game.finished = core.over(); // if not, quit or the recording ran out
+    return GAME_OK;
+}
+
+void addGame(LayoutStats& stats, const GameStats& game)
+{
+    stats.games++;
+    stats.ticks += game.cells.size();
+    for (int i = 0; i <= CAUSE_MAZE_WALL; i++) {
+        stats.deaths[i] += game.deaths[i];
+    }
+    stats.unfinished += game.finished ? 0 : 1;
+    stats.foodEaten += game.foodTimes.size();
+    stats.bonusSpawned += game.bonusSpawned;
+    stats.bonusEaten += game.bonusEaten;
+    stats.bonusExpired += game.bonusExpired;
+    for (uint16_t cell : game.cells) {
+        if (cell < stats.visits.size()) {
+            stats.visits[cell]++;
+        }
+    }
+    for (uint16_t t : game.foodTimes) {
+        stats.foodTicks[t]++;
+    }
+}
+
+// Black through red and yellow to white, on a log scale of visits, with
+// the layout's walls in grey underneath.
+bool writeHeatmap(const LayoutStats& stats, int layout, const string& path)
+{
+    int cols = STATS_WIDTH / STATS_CELL;
+    uint64_t most = *max_element(stats.visits.begin(), stats.visits.end());
+    vector<uint8_t> rgba((size_t)STATS_WIDTH * STATS_HEIGHT * 4, 0);
+    for (size_t i = 3; i < rgba.size(); i += 4) {
+        rgba[i] = 255;
+    }
+    auto fill = [&](int x, int y, int w, int h, uint8_t r, uint8_t g, uint8_t b) {
+        for (int py = max(y, 0); py < min(y + h, STATS_HEIGHT); py++) {
+            for (int px = max(x, 0); px < min(x + w, STATS_WIDTH); px++) {
+                uint8_t* p = &rgba[((size_t)py * STATS_WIDTH + px) * 4];
+                p[0] = r;
+                p[1] = g;
+                p[2] = b;
+            }
+        }
+    };
+
+    CoreRules rules = {STATS_WIDTH, STATS_HEIGHT, STATS_CELL, 1, 1, layout == LAYOUT_MAZE};
+    Segment corners[8], sizes[8];
+    int walls = coreWalls(rules, corners, sizes);
+    for (int i = 0; i < walls; i++) {
+        fill(corners[i].x, corners[i].y, sizes[i].x, sizes[i].y, 48, 48, 48);
+    }
+    for (size_t cell = 0; cell < stats.visits.size(); cell++) {
+        if (stats.visits[cell] == 0) {
+            continue;
+        }
+        double heat = log1p((double)stats.visits[cell]) / log1p((double)most) * 3;
+        auto channel = [&](double from) { return (uint8_t)(255 * min(1.0, max(0.0, heat - from))); };
+        fill((int)(cell % cols) * STATS_CELL, (int)(cell / cols) * STATS_CELL, STATS_CELL, STATS_CELL, channel(0), channel(1), channel(2));
+    }
+
+    vector<uint8_t> png, scratch;
+    encodePng(rgba.data(), STATS_WIDTH, STATS_HEIGHT, png, scratch);
+    ofstream file(path, ios::binary);
+    if (!file.write(reinterpret_cast<const char*>(png.data()), png.size())) {
+        cout << "Error: Could not write " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    vector<string> dirs;
+    string outDir = "replay-stats";
+    int threads = max(1u, thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            outDir = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = max(1, atoi(argv[++i]));
+        } else if (arg.rfind("--", 0) == 0) {
+            cout << "Unknown option " << arg << endl;
+            return 1;
+        } else {
+            dirs.push_back(arg);
+        }
+    }
+    if (dirs.empty()) {
+        cout << "Usage: replay_stats DIR... [--out DIR] [--threads N]" << endl;
+        return 1;
+    }
+
+    vector<string> paths;
+    for (const string& dir : dirs) {
+        error_code ec;
+        for (const auto& entry : filesystem::recursive_directory_iterator(dir, ec)) {
+            if (entry.path().extension() == ".replay") {
+                paths.push_back(entry.path().string());
+            }
+        }
+        if (ec) {
+            cout << "Error: Could not list " << dir << ": " << ec.message() << endl;
+            return 1;
+        }
+    }
+    cout << "Analysing " << paths.size() << " replays on " << threads << " threads" << endl;
+
+    atomic<size_t> nextPath{0};
+    atomic<uint64_t> skipped{0};
+    vector<array<LayoutStats, 2>> perThread(threads);
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            CoreRules largest = {STATS_WIDTH, STATS_HEIGHT, STATS_CELL, 1, 1, true};
+            Arena arena(SnakeCore::bytesFor(largest) + 256);
+            GameStats game;
+            array<LayoutStats, 2>& stats = perThread[t];
+            for (size_t n = nextPath++; n < paths.size(); n = nextPath++) {
+                MappedFile file(paths[n]);
+                int layout = 0;
+                GameResult result = file.data() ? analyse(file.data(), file.size(), arena, game, layout) : GAME_SKIPPED;
+                if (result == GAME_OK) {
+                    addGame(stats[layout], game);
+                } else if (result == GAME_DIVERGED) {
+                    stats[layout].diverged++;
+                } else {
+                    skipped++;
+                }
+            }
+        });
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    array<LayoutStats, 2> total;
+    for (const auto& stats : perThread) {
+        for (int layout = 0; layout < 2; layout++) {
+            total[layout].merge(stats[layout]);
+        }
+    }
+
+    error_code ec;
+    filesystem::create_directories(outDir, ec);
+    ofstream summary(outDir + "/summary.csv");
+    ofstream foodTime(outDir + "/food-time.csv");
+    if (!summary || !foodTime) {
+        cout << "Error: Could not write to " << outDir << endl;
+        return 1;
+    }
+    summary << "layout,games,diverged,ticks,deaths_border_wall,deaths_self,deaths_maze_wall,unfinished,"
+               "food_eaten,food_ticks_mean,food_ticks_median,food_ticks_p90,bonus_spawned,bonus_eaten,bonus_expired,bonus_capture_rate\n";
+    foodTime << "layout,ticks,foods\n";
+    uint64_t games = 0, ticks = 0;
+    for (int layout = 0; layout < 2; layout++) {
+        const LayoutStats& s = total[layout];
+        games += s.games;
+        ticks += s.ticks;
+        if (s.games == 0) {
+            continue;
+        }
+        uint64_t foodTickSum = 0;
+        for (int i = 0; i < FOOD_TIME_BUCKETS; i++) {
+            foodTickSum += (uint64_t)i * s.foodTicks[i];
+            if (s.foodTicks[i] > 0) {
+                foodTime << LAYOUT_NAMES[layout] << "," << i << "," << s.foodTicks[i] << "\n";
+            }
+        }
+        summary << LAYOUT_NAMES[layout] << "," << s.games << "," << s.diverged << "," << s.ticks << "," << s.deaths[CAUSE_BORDER_WALL]
+                << "," << s.deaths[CAUSE_SELF] << "," << s.deaths[CAUSE_MAZE_WALL] << "," << s.unfinished << "," << s.foodEaten << ","
+                << (s.foodEaten ? (double)foodTickSum / s.foodEaten : 0) << "," << s.foodPercentile(0.5) << "," << s.foodPercentile(0.9)
+                << "," << s.bonusSpawned << "," << s.bonusEaten << "," << s.bonusExpired << ","
+                << (s.bonusSpawned ? (double)s.bonusEaten / s.bonusSpawned : 0) << "\n";
+        if (!writeHeatmap(s, layout, outDir + "/heatmap-" + LAYOUT_NAMES[layout] + ".png")) {
+            return 1;
+        }
+        cout << LAYOUT_NAMES[layout] << ": " << s.games << " games, " << s.deaths[CAUSE_BORDER_WALL] << " border, "
+             << s.deaths[CAUSE_SELF] << " self, " << s.deaths[CAUSE_MAZE_WALL] << " maze wall deaths, bonus capture "
+             << (s.bonusSpawned ? 100.0 * s.bonusEaten / s.bonusSpawned : 0) << "%" << (s.diverged ? ", " + to_string(s.diverged) + " diverged" : "")
+             << endl;
+    }
+
+    cout << "Analysed " << games << " games (" << ticks << " ticks, " << skipped << " skipped) in " << fixed << setprecision(2) << seconds
+         << " s, " << setprecision(0) << games / max(seconds, 1e-9) << " games/s; wrote " << outDir << endl;
+    return 0;
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+// Owning handles for SDL objects and a registry of what is alive. Every
+// handle registers itself (count and approximate bytes) under a category
+// when it takes ownership and unregisters when it destroys the object, so
+// resources().report() shows at any time what the process is holding.
+// Bytes are estimates: textures as RGBA pixels, sound chunks as their
+// decoded sample buffer, fonts and music as the size of their file.
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <SDL2/SDL_mixer.h>
+#include <bits/stdc++.h>
+
+enum ResourceCategory {
+    RES_WINDOWS = 0, // windows and renderers
+    RES_TEXTURES,
+    RES_AUDIO,
+    RES_FONTS,
+    RES_GAME_STATE,
+    RES_CATEGORY_COUNT,
+};
+
+inline const char* resourceCategoryName(int category)
+{
+    static const char* names[RES_CATEGORY_COUNT] = {"windows", "textures", "audio", "fonts", "game state"};
+    return names[category];
+}
+
+class ResourceRegistry {
+public:
+    void add(ResourceCategory category, size_t bytes)
+    {
+        counts[category]++;
+        sizes[category] += bytes;
+    }
+
+    void remove(ResourceCategory category, size_t bytes)
+    {
+        counts[category]--;
+        sizes[category] -= bytes;
+    }
+
+    int64_t count(ResourceCategory category) const
+    {
+        return counts[category];
+    }
+
+    int64_t bytes(ResourceCategory category) const
+    {
+        return sizes[category];
+    }
+
+    void report(std::ostream& out, const char* when) const
+    {
+        out << "Resources " << when << ":";
+        for (int i = 0; i < RES_CATEGORY_COUNT; i++) {
+            out << " " << resourceCategoryName(i) << " " << counts[i] << " (" << std::fixed << std::setprecision(1)
+                << sizes[i] / 1024.0 << " KiB)" << (i + 1 < RES_CATEGORY_COUNT ? "," : "");
+        }
+        out << std::endl;
+    }
+
+private:
+    std::atomic<int64_t> counts[RES_CATEGORY_COUNT] = {};
+    std::atomic<int64_t> sizes[RES_CATEGORY_COUNT] = {};
+};
+
+// Never destroyed, so handles held by other statics can still unregister
+// while the process exits.
+inline ResourceRegistry& resources()
+{
+    static ResourceRegistry* registry = new ResourceRegistry;
+    return *registry;
+}
+
+// Move-only owner of one SDL object, destroyed with Destroy.
+template <class T, void (*Destroy)(T*), ResourceCategory Category>
+class Handle {
+public:
+    Handle() = default;
+
+    explicit Handle(T* object, size_t bytes = 0)
+    {
+        reset(object, bytes);
+    }
+
+    Handle(Handle&& other) noexcept : object(other.object), size(other.size)
+    {
+        other.object = nullptr;
+        other.size = 0;
+    }
+
+    Handle& operator=(Handle&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            object = other.object;
+            size = other.size;
+            other.object = nullptr;
+            other.size = 0;
+        }
+        return *this;
+    }
+
+    Handle(const Handle&) = delete;
+    Handle& operator=(const Handle&) = delete;
+
+    ~Handle()
+    {
+        reset();
+    }
+
+    T* get() const
+    {
+        return object;
+    }
+
+    explicit operator bool() const
+    {
+        return object != nullptr;
+    }
+
+    void reset(T* replacement = nullptr, size_t bytes = 0)
+    {
+        if (object) {
+            Destroy(object);
+            resources().remove(Category, size);
+        }
+        object = replacement;
+        size = replacement ? bytes : 0;
+        if (object) {
+            resources().add(Category, size);
+        }
+    }
+
+private:
+    T* object = nullptr;
+    size_t size = 0;
+};
+
+using WindowHandle = Handle<SDL_Window, SDL_DestroyWindow, RES_WINDOWS>;
+using RendererHandle = Handle<SDL_Renderer, SDL_DestroyRenderer, RES_WINDOWS>;
+using TextureHandle = Handle<SDL_Texture, SDL_DestroyTexture, RES_TEXTURES>;
+using SurfaceHandle = Handle<SDL_Surface, SDL_FreeSurface, RES_TEXTURES>;
+using FontHandle = Handle<TTF_Font, TTF_CloseFont, RES_FONTS>;
+using ChunkHandle = Handle<Mix_Chunk, Mix_FreeChunk, RES_AUDIO>;
+using MusicHandle = Handle<Mix_Music, Mix_FreeMusic, RES_AUDIO>;
+
+inline size_t fileBytes(const char* path)
+{
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(path, ec);
+    return ec ? 0 : (size_t)size;
+}
+
+inline TextureHandle ownTexture(SDL_Texture* texture)
+{
+    int w = 0, h = 0;
+    if (texture) {
+        SDL_QueryTexture(texture, nullptr, nullptr, &w, &h);
+    }
+    return TextureHandle(texture, (size_t)w * h * 4);
+}
+
+inline SurfaceHandle ownSurface(SDL_Surface* surface)
+{
+    return SurfaceHandle(surface, surface ? (size_t)surface->pitch * surface->h : 0);
+}
+
+inline ChunkHandle ownChunk(Mix_Chunk* chunk)
+{
+    return ChunkHandle(chunk, chunk ? chunk->alen : 0);
+}
+
+inline MusicHandle ownMusic(Mix_Music* music, const char* path)
+{
+    return MusicHandle(music, fileBytes(path));
+}
+
+inline FontHandle ownFont(TTF_Font* font, const char* path)
+{
+    return FontHandle(font, fileBytes(path));
+}
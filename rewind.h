@@ -0,0 +1,167 @@
+#pragma once
+
+// Rewind for task301: the last few seconds of a game as a ring of per-tick
+// deltas, so the player can undo a death or a maze pause and take another
+// turn from a few ticks earlier. Every tick the snake moved costs one
+// fixed-size RewindDelta (the cell the head entered, the cell the tail
+// left, and the food, bonus, score and RNG from before the tick), however
+// long the snake is; the ring and the scratch body are handed in up front,
+// so nothing is allocated while the game runs. Rewinding undoes the deltas
+// newest first on a copy of the body and hands the result to
+// SnakeCore::restore, after which the game plays on exactly as it did from
+// that tick.
+
+#include "snake_core.h"
+
+const uint16_t REWIND_NO_CELL = 0xFFFF;
+
+enum RewindFlags : uint8_t {
+    REWIND_WAS_PAUSED = 1,
+    REWIND_BONUS_CHANGED = 2,
+    REWIND_HAD_BONUS = 4, // before the tick; with REWIND_BONUS_CHANGED
+};
+
+struct RewindDelta {
+    uint64_t random;     // RNG state before the tick
+    uint16_t head;       // cell the head moved into
+    uint16_t tail;       // cell the tail left, REWIND_NO_CELL if the snake grew
+    uint16_t food;       // food before the tick, REWIND_NO_CELL if it stayed
+    uint16_t bonus;      // with REWIND_BONUS_CHANGED: the bonus before the tick
+    uint16_t bonusLeft;  // and the ticks it had left
+    int16_t scoreDelta;
+    uint8_t foodCounter; // before the tick
+    uint8_t flags;
+};
+
+class RewindBuffer {
+public:
+    // Room for capacity ticks in deltas; scratch holds the whole board plus
+    // capacity segments.
+    void begin(const CoreRules& rules, RewindDelta* deltas, int capacity, Segment* scratch)
+    {
+        cellSize = rules.cellSize;
+        cols = rules.screenWidth / rules.cellSize;
+        ring = deltas;
+        ringCapacity = capacity;
+        body = scratch;
+        newest = 0;
+        count = 0;
+    }
+
+    static size_t bytesFor(const CoreRules& rules, int capacity)
+    {
+        size_t cells = (size_t)(rules.screenWidth / rules.cellSize) * (rules.screenHeight / rules.cellSize);
+        return capacity * sizeof(RewindDelta) + (cells + capacity) * sizeof(Segment) + 16;
+    }
+
+    // Call before each tick, and afterTick once it has run.
+    void beforeTick(const SnakeCore& core)
+    {
+        before = core.state();
+        tailBefore = core.body()[core.body().size() - 1];
+        lengthBefore = core.body().size();
+    }
+
+    // Keeps the tick if the snake moved; the oldest one kept is dropped
+    // once the ring is full.
+    void afterTick(const SnakeCore& core)
+    {
+        if (!core.moved() || ringCapacity == 0) {
+            return;
+        }
+        CoreState after = core.state();
+        RewindDelta& d = ring[newest];
+        newest = (newest + 1) % ringCapacity;
+        count = std::min(count + 1, ringCapacity);
+
+        d.random = before.random;
+        d.head = cellOf(core.body()[0]);
+        d.tail = core.body().size() > lengthBefore ? REWIND_NO_CELL : cellOf(tailBefore);
+        d.food = after.food.x != before.food.x || after.food.y != before.food.y ? cellOf(before.food) : REWIND_NO_CELL;
+        d.scoreDelta = (int16_t)(after.score - before.score);
+        d.foodCounter = (uint8_t)before.foodCounter;
+        d.flags = before.paused ? REWIND_WAS_PAUSED : 0;
+        if (after.bonusActive != before.bonusActive ||
+            (before.bonusActive && (after.bonus.x != before.bonus.x || after.bonus.y != before.bonus.y ||
+                                    after.bonusExpiresAt != before.bonusExpiresAt))) {
+            d.flags |= REWIND_BONUS_CHANGED | (before.bonusActive ? REWIND_HAD_BONUS : 0);
+            d.bonus = before.bonusActive ? cellOf(before.bonus) : REWIND_NO_CELL;
+            d.bonusLeft = before.bonusActive ? (uint16_t)(before.bonusExpiresAt - before.tick) : 0;
+        }
+    }
+
+    // Ticks that can be undone.
+    int size() const
+    {
+        return count;
+    }
+
+    // Puts the game back by up to ticks moves; returns how many it undid.
+    int rewind(SnakeCore& core, int ticks)
+    {
+        CoreState s = core.state();
+        int first = 0, end = 0;
+        core.body().forEachCell([&](uint32_t cell) { body[end++] = cellAt((uint16_t)cell); });
+
+        int undone = 0;
+        while (undone < ticks && count > 0) {
+            const RewindDelta& d = ring[(newest + ringCapacity - 1) % ringCapacity];
+            if (cellOf(body[first]) != d.head) {
+                break; // out of step with the body; keep what is undone so far
+            }
+            newest = (newest + ringCapacity - 1) % ringCapacity;
+            count--;
+            undone++;
+
+            first++;
+            if (d.tail != REWIND_NO_CELL) {
+                body[end++] = cellAt(d.tail);
+            }
+            s.tick--;
+            s.random = d.random;
+            s.score -= d.scoreDelta;
+            s.foodCounter = d.foodCounter;
+            s.paused = d.flags & REWIND_WAS_PAUSED;
+            if (d.food != REWIND_NO_CELL) {
+                s.food = cellAt(d.food);
+            }
+            if (d.flags & REWIND_BONUS_CHANGED) {
+                s.bonusActive = d.flags & REWIND_HAD_BONUS;
+                s.bonus = s.bonusActive ? cellAt(d.bonus) : Segment{0, 0};
+                s.bonusExpiresAt = s.bonusActive ? s.tick + d.bonusLeft : 0;
+            }
+        }
+        if (undone > 0) {
+            core.restore(s, body + first, end - first);
+        }
+        return undone;
+    }
+
+    // Memory held, for the cost report.
+    void print(std::ostream& out) const
+    {
+        out << "rewind: " << count << " of " << ringCapacity << " ticks kept, " << ringCapacity * sizeof(RewindDelta) << " bytes ("
+            << sizeof(RewindDelta) << " a tick, whatever the length)" << std::endl;
+    }
+
+private:
+    int cellSize = 1, cols = 1;
+    RewindDelta* ring = nullptr;
+    int ringCapacity = 0;
+    int newest = 0; // where the next delta goes
+    int count = 0;
+    Segment* body = nullptr;
+    CoreState before = {};
+    Segment tailBefore = {};
+    size_t lengthBefore = 0;
+
+    uint16_t cellOf(const Segment& s) const
+    {
+        return (uint16_t)(s.y / cellSize * cols + s.x / cellSize);
+    }
+
+    Segment cellAt(uint16_t cell) const
+    {
+        return {cell % cols * cellSize, cell / cols * cellSize};
+    }
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+// An in-progress game saved on quit and resumed on the next start. The file
+// is a fixed header (rules, score, RNG state, tick, food, bonus and its
+// expiry tick, direction) followed by the body: the head's cell as a
+// varint, then two bits per segment for the step to the next one, so a
+// save grows with the snake's length, not with the board. A CRC covers
+// the whole file. The whole file is built in memory and written with
+// one write to a temp file that is renamed over the old save (no fsync:
+// losing a save to a power cut is acceptable, a torn one is not). Loading
+// maps the file and decodes the body straight out of the mapping.
+
+#include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+#include "crc32.h"
+#include "mapped_file.h"
+#include "snake_core.h"
+#include "replay.h"
+
+const uint32_t SAVE_MAGIC = 0x56534E53; // "SNSV"
+const uint16_t SAVE_VERSION = 1;
+
+enum SaveFlags : uint8_t {
+    SAVE_PAUSED = 1,
+    SAVE_BONUS = 2,
+};
+
+struct SaveHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t layout;    // ReplayLayout
+    uint8_t flags;
+    uint16_t screenWidth, screenHeight, cellSize;
+    uint8_t direction; // packed, as the simulation reads it
+    uint8_t reserved;
+    uint64_t random;
+    uint32_t tick;
+    int32_t score;
+    int32_t foodCounter;
+    uint32_t bonusExpiresAt;
+    int16_t foodX, foodY, bonusX, bonusY;
+    uint32_t length;
+    uint32_t bodyBytes;
+    uint32_t crc;      // of the header with this field 0, then the body
+    uint32_t pad;      // no implicit padding, so the CRC sees only set bytes
+};
+
+// Step from one segment to the next, as two bits.
+const int SAVE_STEPS[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+inline const char* saveFileFor(ReplayLayout layout)
+{
+    return layout == LAYOUT_MAZE ? "savegame-maze.dat" : "savegame-classic.dat";
+}
+
+// Writes the game to path; false if it could not, or if the body has a
+// gap no two-bit step can describe.
+inline bool writeSave(const std::string& path, ReplayLayout layout, const CoreRules& rules, const SnakeCore& core, int direction)
+{
+    const SnakeBody<Segment>& body = core.body();
+    CoreState state = core.state();
+    SaveHeader header = {};
+    header.magic = SAVE_MAGIC;
+    header.version = SAVE_VERSION;
+    header.layout = layout;
+    header.flags = (state.paused ? SAVE_PAUSED : 0) | (state.bonusActive ? SAVE_BONUS : 0);
+    header.screenWidth = (uint16_t)rules.screenWidth;
+    header.screenHeight = (uint16_t)rules.screenHeight;
+    header.cellSize = (uint16_t)rules.cellSize;
+    header.direction = (uint8_t)direction;
+    header.random = state.random;
+    header.tick = state.tick;
+    header.score = state.score;
+    header.foodCounter = state.foodCounter;
+    header.bonusExpiresAt = state.bonusExpiresAt;
+    header.foodX = (int16_t)state.food.x;
+    header.foodY = (int16_t)state.food.y;
+    header.bonusX = (int16_t)state.bonus.x;
+    header.bonusY = (int16_t)state.bonus.y;
+    header.length = (uint32_t)body.size();
+
+    std::vector<uint8_t> bytes(sizeof(header) + 5 + body.size() / 4 + 1);
+    uint8_t* out = bytes.data() + sizeof(header);
+    uint32_t head = body.cellAt(0);
+    do {
+        *out++ = (uint8_t)(head & 0x7F) | (head > 0x7F ? 0x80 : 0);
+        head >>= 7;
+    } while (head);
+    uint8_t* steps = out;
+    int cols = rules.screenWidth / rules.cellSize;
+    size_t i = 0;
+    uint32_t previous = 0;
+    bool gap = false;
+    body.forEachCell([&](uint32_t cell) {
+        if (i > 0 && !gap) {
+            int dx = (int)(cell % cols) - (int)(previous % cols), dy = (int)(cell / cols) - (int)(previous / cols);
+            int step = 0;
+            while (step < 4 && (dx != SAVE_STEPS[step][0] || dy != SAVE_STEPS[step][1])) {
+                step++;
+            }
+            if (step == 4) {
+                std::cout << "Error: Snake body has a gap at segment " << i << ", not saved" << std::endl;
+                gap = true;
+            }
+            steps[(i - 1) / 4] |= (uint8_t)((step & 3) << ((i - 1) % 4 * 2));
+        }
+        previous = cell;
+        i++;
+    });
+    if (gap) {
+        return false;
+    }
+    out = steps + (body.size() + 2) / 4;
+    header.bodyBytes = (uint32_t)(out - bytes.data() - sizeof(header));
+    header.crc = crc32(&header, sizeof(header));
+    header.crc = crc32(bytes.data() + sizeof(header), header.bodyBytes, header.crc);
+    memcpy(bytes.data(), &header, sizeof(header));
+    size_t size = out - bytes.data();
+
+    std::string temp = path + ".tmp";
+#ifdef _WIN32
+    int fd = _open(temp.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+    bool ok = fd >= 0 && _write(fd, bytes.data(), (unsigned)size) == (int)size;
+    if (fd >= 0) {
+        _close(fd);
+    }
+    ok = ok && MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0 && write(fd, bytes.data(), size) == (ssize_t)size;
+    if (fd >= 0) {
+        close(fd);
+    }
+    ok = ok && rename(temp.c_str(), path.c_str()) == 0;
+#endif
+    if (!ok) {
+        std::cout << "Error: Could not write save " << path << std::endl;
+    }
+    return ok;
+}
+
+// Loads a save made by writeSave for the same layout and rules into state,
+// body (head first, cells carved from arena) and direction. False, with a
+// message, if the file is damaged or from other rules; false quietly if
+// there is none.
+inline bool readSave(const std::string& path, ReplayLayout layout, const CoreRules& rules, Arena& arena, CoreState& state,
+                     Segment*& body, int& length, int& direction)
+{
+    MappedFile file(path);
+    if (!file.data()) {
+        return false;
+    }
+    SaveHeader header;
+    if (file.size() < sizeof(header)) {
+        std::cout << "Error: Save " << path << " is truncated" << std::endl;
+        return false;
+    }
+    memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != SAVE_MAGIC || header.version != SAVE_VERSION || header.layout != layout ||
+        header.screenWidth != rules.screenWidth || header.screenHeight != rules.screenHeight || header.cellSize != rules.cellSize) {
+        std::cout << "Error: " << path << " is not a version " << SAVE_VERSION << " save for this game" << std::endl;
+        return false;
+    }
+    int cols = rules.screenWidth / rules.cellSize, rows = rules.screenHeight / rules.cellSize;
+    const uint8_t* in = file.data() + sizeof(header);
+    SaveHeader zeroed = header;
+    zeroed.crc = 0;
+    if (header.bodyBytes > file.size() - sizeof(header) ||
+        crc32(in, header.bodyBytes, crc32(&zeroed, sizeof(zeroed))) != header.crc || header.length == 0 ||
+        header.length > (uint32_t)cols * rows) {
+        std::cout << "Error: Save " << path << " is damaged" << std::endl;
+        return false;
+    }
+
+    const uint8_t* end = in + header.bodyBytes;
+    uint32_t head = 0;
+    for (int shift = 0; in < end && shift < 35; shift += 7) {
+        head |= (uint32_t)(*in & 0x7F) << shift;
+        if (!(*in++ & 0x80)) {
+            break;
+        }
+    }
+    auto onBoard = [&](int x, int y) {
+        return x >= 0 && y >= 0 && x < rules.screenWidth && y < rules.screenHeight && x % rules.cellSize == 0 && y % rules.cellSize == 0;
+    };
+    bool bonusActive = header.flags & SAVE_BONUS;
+    if ((size_t)(end - in) < (header.length + 2) / 4 || head >= (uint32_t)cols * rows || !onBoard(header.foodX, header.foodY) ||
+        (bonusActive && (!onBoard(header.bonusX, header.bonusY) || header.bonusExpiresAt <= header.tick))) {
+        std::cout << "Error: Save " << path << " is damaged" << std::endl;
+        return false;
+    }
+    body = arena.allocate<Segment>(header.length);
+    body[0] = {(int)(head % cols) * rules.cellSize, (int)(head / cols) * rules.cellSize};
+    for (uint32_t i = 1; i < header.length; i++) {
+        int step = in[(i - 1) / 4] >> ((i - 1) % 4 * 2) & 3;
+        body[i] = {body[i - 1].x + SAVE_STEPS[step][0] * rules.cellSize, body[i - 1].y + SAVE_STEPS[step][1] * rules.cellSize};
+    }
+    length = (int)header.length;
+
+    state = {};
+    state.random = header.random;
+    state.tick = header.tick;
+    state.score = header.score;
+    state.foodCounter = header.foodCounter;
+    state.paused = header.flags & SAVE_PAUSED;
+    state.food = {header.foodX, header.foodY};
+    state.bonusActive = bonusActive;
+    state.bonus = {header.bonusX, header.bonusY};
+    state.bonusExpiresAt = header.bonusExpiresAt;
+    direction = header.direction;
+    return true;
+}
@@ -0,0 +1,428 @@
+#include <bits/stdc++.h>
+#include <csignal>
+#include "net_socket.h"
+#include "deflate.h"
+
+using namespace std;
+
+// Stand-in for the central leaderboard that score_sync.h posts to, for
+// testing kiosks without the real service.
+//   score_server [--port N] [--fail-percent P] [--db FILE]
+// Takes POST /scores (JSON, plain or Content-Encoding: deflate), keeps
+// every result it has not seen before in a CSV file and prints the top
+// scores across all kiosks after each batch; GET /leaderboard returns
+// them as text. --fail-percent answers that share of posts with 503 and
+// Retry-After, to exercise the client's backoff. One connection at a
+// time, which is plenty for a test bench.
+
+const int DEFAULT_PORT = 40151;
+const size_t MAX_HEADERS = 16 * 1024;
+const size_t MAX_BODY = 1 << 20;
+const size_t MAX_INFLATED = 8 << 20;
+const int IO_TIMEOUT_MS = 5000;
+const int TOP_SHOWN = 10;
+
+volatile sig_atomic_t running = 1;
+
+void stopServer(int)
+{
+    running = 0;
+}
+
+struct StoredResult {
+    string kiosk;
+    uint64_t seq = 0;
+    long long score = 0, length = 0, durationMs = 0, endedAt = 0;
+    string replayHash, layout;
+};
+
+// Pulls the fields out of the flat objects score_sync.h writes: enough for
+// that one format, not a general JSON parser.
+class BatchParser {
+public:
+    explicit BatchParser(const string& text) : text(text) {}
+
+    bool parse(string& kiosk, vector<StoredResult>& results)
+    {
+        if (!expect('{')) {
+            return false;
+        }
+        while (ok && !peek('}')) {
+            string key = readString();
+            expect(':');
+            if (key == "kiosk") {
+                kiosk = readString();
+            } else if (key == "results") {
+                expect('[');
+                while (ok && !peek(']')) {
+                    results.push_back(readResult());
+                    skip(',');
+                }
+                expect(']');
+            } else {
+                readValue();
+            }
+            skip(',');
+        }
+        return expect('}') && !kiosk.empty();
+    }
+
+private:
+    const string& text;
+    size_t pos = 0;
+    bool ok = true;
+
+    void space()
+    {
+        while (pos < text.size() && isspace((unsigned char)text[pos])) {
+            pos++;
+        }
+    }
+
+    bool peek(char c)
+    {
+        space();
+        ok = ok && pos < text.size();
+        return ok && text[pos] == c;
+    }
+
+    bool expect(char c)
+    {
+        ok = ok && peek(c);
+        pos++;
+        return ok;
+    }
+
+    void skip(char c)
+    {
+        if (peek(c)) {
+            pos++;
+        }
+    }
+
+    string readString()
+    {
+        string s;
+        if (!expect('"')) {
+            return s;
+        }
+        while (pos < text.size() && text[pos] != '"') {
+            if (text[pos] == '\\' && pos + 1 < text.size()) {
+                pos++;
+            }
+            s += text[pos++];
+        }
+        ok = ok && pos < text.size();
+        pos++;
+        return s;
+    }
+
+    // A number or a string, as text.
+    string readValue()
+    {
+        if (peek('"')) {
+            return readString();
+        }
+        size_t start = pos;
+        while (pos < text.size() && (isdigit((unsigned char)text[pos]) || text[pos] == '-')) {
+            pos++;
+        }
+        ok = ok && pos > start;
+        return text.substr(start, pos - start);
+    }
+
+    StoredResult readResult()
+    {
+        StoredResult r;
+        expect('{');
+        while (ok && !peek('}')) {
+            string key = readString();
+            expect(':');
+            string value = readValue();
+            long long number = atoll(value.c_str());
+            if (key == "seq") r.seq = (uint64_t)number;
+            else if (key == "score") r.score = number;
+            else if (key == "length") r.length = number;
+            else if (key == "duration_ms") r.durationMs = number;
+            else if (key == "ended_at") r.endedAt = number;
+            else if (key == "replay_hash") r.replayHash = value;
+            else if (key == "layout") r.layout = value;
+            skip(',');
+        }
+        expect('}');
+        ok = ok && r.seq > 0;
+        return r;
+    }
+};
+
+class ScoreServer {
+public:
+    ScoreServer(const string& dbPath, int failPercent) : dbPath(dbPath), failPercent(failPercent), random((uint32_t)time(nullptr)) {}
+
+    bool listen(uint16_t port)
+    {
+        if (!socketsInit()) {
+            return false;
+        }
+        load();
+        sock = socket(AF_INET, SOCK_STREAM, 0);
+        int on = 1;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (const char*)&on, sizeof(on));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+        if (sock == (socket_t)-1 || bind(sock, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(sock, 16) != 0) {
+            cout << "Could not listen on TCP port " << port << endl;
+            return false;
+        }
+        return true;
+    }
+
+    void run()
+    {
+        while (running) {
+            if (!waitReadable(sock, 500)) {
+                continue;
+            }
+            socket_t client = accept(sock, nullptr, nullptr);
+            if (client == (socket_t)-1) {
+                continue;
+            }
+#ifdef _WIN32
+            DWORD timeout = IO_TIMEOUT_MS;
+#else
+            timeval timeout = {IO_TIMEOUT_MS / 1000, 0};
+#endif
+            setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+            setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+            handle(client);
+            closeSocket(client);
+        }
+        closeSocket(sock);
+        cout << "Stopped with " << results.size() << " results from " << kiosks() << " kiosks" << endl;
+    }
+
+private:
+    string dbPath;
+    int failPercent;
+    mt19937 random;
+    socket_t sock = (socket_t)-1;
+    vector<StoredResult> results;
+    unordered_set<string> seen; // kiosk + "#" + seq
+
+    static bool waitReadable(socket_t s, int timeoutMs)
+    {
+#ifdef _WIN32
+        fd_set set;
+        FD_ZERO(&set);
+        FD_SET(s, &set);
+        timeval tv = {0, timeoutMs * 1000};
+        return select(0, &set, nullptr, nullptr, &tv) > 0;
+#else
+        pollfd pfd = {s, POLLIN, 0};
+        return poll(&pfd, 1, timeoutMs) > 0;
+#endif
+    }
+
+    void handle(socket_t client)
+    {
+        string request;
+        char buffer[4096];
+        size_t headerEnd;
+        while ((headerEnd = request.find("\r\n\r\n")) == string::npos) {
+            int n = (int)recv(client, buffer, sizeof(buffer), 0);
+            if (n <= 0 || request.size() > MAX_HEADERS) {
+                return;
+            }
+            request.append(buffer, n);
+        }
+        string headers = request.substr(0, headerEnd + 2);
+        string lower = headers;
+        transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        auto header = [&](const string& name) {
+            size_t at = lower.find("\r\n" + name + ":");
+            if (at == string::npos) {
+                return string();
+            }
+            size_t start = at + name.size() + 3, end = lower.find("\r\n", start);
+            string value = lower.substr(start, end - start);
+            value.erase(0, value.find_first_not_of(' '));
+            return value;
+        };
+
+        char method[16] = {}, target[256] = {};
+        sscanf(headers.c_str(), "%15s %255s", method, target);
+        if (string(method) == "GET" && string(target) == "/leaderboard") {
+            respond(client, 200, leaderboardText());
+            return;
+        }
+        if (string(method) != "POST" || string(target) != "/scores") {
+            respond(client, 404, "Not found\n");
+            return;
+        }
+
+        size_t length = (size_t)atoll(header("content-length").c_str());
+        if (length > MAX_BODY) {
+            respond(client, 413, "Batch too large\n");
+            return;
+        }
+        string body = request.substr(headerEnd + 4);
+        while (body.size() < length) {
+            int n = (int)recv(client, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                return;
+            }
+            body.append(buffer, n);
+        }
+        body.resize(length);
+
+        string encoding = header("content-encoding");
+        string json;
+        if (encoding == "deflate") {
+            vector<uint8_t> inflated;
+            if (!zlibInflate(reinterpret_cast<const uint8_t*>(body.data()), body.size(), inflated, MAX_INFLATED)) {
+                respond(client, 400, "Body is not a zlib stream this server can inflate\n");
+                return;
+            }
+            json.assign(inflated.begin(), inflated.end());
+        } else if (encoding.empty() || encoding == "identity") {
+            json = body;
+        } else {
+            respond(client, 415, "Unsupported Content-Encoding\n");
+            return;
+        }
+
+        if ((int)(random() % 100) < failPercent) {
+            respond(client, 503, "Injected failure\n", "Retry-After: 1\r\n");
+            return;
+        }
+
+        string kiosk;
+        vector<StoredResult> batch;
+        if (!BatchParser(json).parse(kiosk, batch)) {
+            respond(client, 400, "Malformed batch\n");
+            return;
+        }
+        int accepted = 0, duplicates = 0;
+        ofstream db(dbPath, ios::app);
+        for (StoredResult& r : batch) {
+            r.kiosk = kiosk;
+            if (!seen.insert(kiosk + "#" + to_string(r.seq)).second) {
+                duplicates++;
+                continue;
+            }
+            db << r.kiosk << "," << r.seq << "," << r.score << "," << r.length << "," << r.durationMs << "," << r.replayHash << ","
+               << r.layout << "," << r.endedAt << "\n";
+            results.push_back(r);
+            accepted++;
+        }
+        db.flush();
+        if (!db) {
+            respond(client, 500, "Could not store the batch\n");
+            return;
+        }
+        respond(client, 200, "{\"accepted\":" + to_string(accepted) + ",\"duplicates\":" + to_string(duplicates) + "}\n");
+
+        cout << kiosk << ": " << accepted << " results (" << duplicates << " duplicates, " << body.size() << " bytes for "
+             << json.size() << ")" << endl;
+        cout << leaderboardText();
+    }
+
+    static void respond(socket_t client, int status, const string& body, const string& extra = "")
+    {
+        const char* reason = status == 200 ? "OK" : status == 400 ? "Bad Request" : status == 404 ? "Not Found" :
+                             status == 413 ? "Payload Too Large" : status == 415 ? "Unsupported Media Type" :
+                             status == 503 ? "Service Unavailable" : "Internal Server Error";
+        string response = "HTTP/1.1 " + to_string(status) + " " + reason + "\r\nContent-Length: " + to_string(body.size()) +
+                          "\r\nConnection: close\r\n" + extra + "\r\n" + body;
+        send(client, response.data(), (int)response.size(), 0);
+    }
+
+    string leaderboardText() const
+    {
+        vector<const StoredResult*> top;
+        for (const StoredResult& r : results) {
+            top.push_back(&r);
+        }
+        size_t shown = min<size_t>(top.size(), TOP_SHOWN);
+        partial_sort(top.begin(), top.begin() + shown, top.end(),
+                     [](const StoredResult* a, const StoredResult* b) { return a->score > b->score; });
+        ostringstream out;
+        for (size_t i = 0; i < shown; i++) {
+            out << setw(3) << i + 1 << ". " << setw(6) << top[i]->score << "  " << top[i]->kiosk << " (" << top[i]->layout << ", length "
+                << top[i]->length << ")\n";
+        }
+        return out.str();
+    }
+
+    size_t kiosks() const
+    {
+        set<string> names;
+        for (const StoredResult& r : results) {
+            names.insert(r.kiosk);
+        }
+        return names.size();
+    }
+
+    // Results from earlier runs, so a resent batch is still recognised.
+    void load()
+    {
+        ifstream db(dbPath);
+        string line;
+        while (getline(db, line)) {
+            StoredResult r;
+            stringstream fields(line);
+            string seq, score, length, duration, ended;
+            getline(fields, r.kiosk, ',');
+            getline(fields, seq, ',');
+            getline(fields, score, ',');
+            getline(fields, length, ',');
+            getline(fields, duration, ',');
+            getline(fields, r.replayHash, ',');
+            getline(fields, r.layout, ',');
+            getline(fields, ended, ',');
+            r.seq = strtoull(seq.c_str(), nullptr, 10);
+            r.score = atoll(score.c_str());
+            r.length = atoll(length.c_str());
+            r.durationMs = atoll(duration.c_str());
+            r.endedAt = atoll(ended.c_str());
+            if (r.seq > 0 && seen.insert(r.kiosk + "#" + to_string(r.seq)).second) {
+                results.push_back(r);
+            }
+        }
+        if (!results.empty()) {
+            cout << "Loaded " << results.size() << " results from " << dbPath << endl;
+        }
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    int port = DEFAULT_PORT, failPercent = 0;
+    string db = "score_server.csv";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--port") port = atoi(argv[i + 1]);
+        else if (arg == "--fail-percent") failPercent = atoi(argv[i + 1]);
+        else if (arg == "--db") db = argv[i + 1];
+        else {
+            cout << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    signal(SIGINT, stopServer);
+#ifndef _WIN32
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    ScoreServer server(db, failPercent);
+    if (!server.listen((uint16_t)port)) {
+        return 1;
+    }
+    cout << "Taking scores on http://localhost:" << port << "/scores" << (failPercent ? ", failing " + to_string(failPercent) + "%" : "")
+         << endl;
+    server.run();
+    return 0;
+}
@@ -0,0 +1,482 @@
+#pragma once
+
+// Central leaderboard for a fleet of kiosks. Every finished game is queued
+// as a ScoreResult; a background thread appends it to a durable local
+// outbox (scores-outbox.dat: one CRC-checked record per game, fsynced) and
+// posts the outbox in batches to an HTTP endpoint as deflate-compressed
+// JSON. Results leave the outbox only once the server has answered 2xx,
+// so a kiosk that is offline for days delivers everything when it comes
+// back. Failed posts back off exponentially with jitter (1 s doubling up
+// to 5 minutes, or longer if the server sends Retry-After). Each result
+// carries the kiosk id and a per-kiosk sequence number, so the server can
+// drop a batch it already has when a lost response makes the kiosk resend
+// it. submit() only takes a mutex for a push_back: the game never waits on
+// the disk or the network. score_server is a stand-in for the endpoint.
+//
+//   POST <path>  Content-Encoding: deflate
+//   {"kiosk":"...","results":[{"seq":1,"score":340,"length":25,
+//     "duration_ms":61234,"replay_hash":"1a2b3c4d","layout":"maze",
+//     "ended_at":1760000000},...]}
+
+#include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "net_socket.h"
+#ifdef _WIN32
+    #include <io.h>
+#endif
+#include "crc32.h"
+#include "deflate.h"
+#include "replay.h"
+
+const char* const SYNC_OUTBOX_FILE = "scores-outbox.dat";
+const char* const SYNC_OUTBOX_TEMP_FILE = "scores-outbox.dat.tmp";
+const uint32_t SYNC_MAGIC = 0x424F4E53; // "SNOB"
+const uint16_t SYNC_VERSION = 1;
+const size_t SYNC_BATCH = 50;          // results per post
+const int SYNC_TIMEOUT_MS = 3000;      // connect, and each send or receive
+const int SYNC_BACKOFF_MIN_MS = 1000;
+const int SYNC_BACKOFF_MAX_MS = 300000;
+const size_t SYNC_MAX_RESPONSE = 4096; // only the status line and headers matter
+
+struct ScoreResult {
+    uint64_t seq; // per kiosk, from 1
+    int64_t endedAt;
+    int32_t score;
+    int32_t length;
+    uint32_t durationMs;
+    uint32_t replayHash; // ReplayRecorder::hash, 0 if no replay was kept
+    uint32_t layout;     // ReplayLayout
+    uint32_t reserved;
+};
+
+struct SyncOutboxHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint64_t nextSeq; // as of the last rewrite; appended records may be newer
+};
+
+class ScoreSync {
+public:
+    ~ScoreSync()
+    {
+        stop();
+    }
+
+    // Starts syncing to url (http://host[:port]/path) as kiosk, or as this
+    // machine's host name if kiosk is empty. False, with a message, if the
+    // url is not one it can post to.
+    bool start(const std::string& url, std::string kiosk)
+    {
+        std::string rest = url;
+        if (rest.compare(0, 7, "http://") != 0) {
+            std::cout << "Error: Score sync needs an http:// url, not " << url << std::endl;
+            return false;
+        }
+        rest = rest.substr(7);
+        size_t slash = rest.find('/');
+        path = slash == std::string::npos ? "/" : rest.substr(slash);
+        host = rest.substr(0, slash);
+        port = "80";
+        size_t colon = host.find(':');
+        if (colon != std::string::npos) {
+            port = host.substr(colon + 1);
+            host = host.substr(0, colon);
+        }
+        if (host.empty() || port.empty() || !socketsInit()) {
+            std::cout << "Error: Bad score sync url " << url << std::endl;
+            return false;
+        }
+        if (kiosk.empty()) {
+            char name[256] = {};
+            kiosk = gethostname(name, sizeof(name) - 1) == 0 && name[0] ? name : "kiosk";
+        }
+        kioskId = kiosk;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!worker.joinable()) {
+            worker = std::thread(&ScoreSync::syncLoop, this);
+        }
+        return true;
+    }
+
+    bool enabled() const
+    {
+        return !kioskId.empty();
+    }
+
+    // Queues a finished game; does nothing unless start() succeeded.
+    void submit(int score, int length, uint32_t durationMs, uint32_t replayHash, ReplayLayout layout)
+    {
+        if (!enabled()) {
+            return;
+        }
+        ScoreResult result = {};
+        result.endedAt = (int64_t)time(nullptr);
+        result.score = score;
+        result.length = length;
+        result.durationMs = durationMs;
+        result.replayHash = replayHash;
+        result.layout = layout;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            incoming.push_back(result);
+        }
+        wake.notify_one();
+    }
+
+    // Writes queued results to the outbox and stops the thread; a post in
+    // flight finishes (or times out) first. Whatever was not delivered is
+    // sent by the next process.
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!worker.joinable()) {
+                return;
+            }
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+        stopping = false;
+    }
+
+    // Call after stop().
+    void report(std::ostream& out) const
+    {
+        if (!enabled()) {
+            return;
+        }
+        out << "Score sync: " << sentResults << " results sent in " << batches << " batches (" << bytesSent << " bytes, "
+            << std::fixed << std::setprecision(1) << (bytesSent ? (double)bytesJson / bytesSent : 0.0) << "x compressed), "
+            << failures << " failed posts, " << outbox.size() << " waiting in " << SYNC_OUTBOX_FILE << std::endl;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::string host, port, path, kioskId;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<ScoreResult> incoming;
+    bool stopping = false;
+
+    // Only the sync thread touches these while it runs.
+    std::vector<ScoreResult> outbox;
+    uint64_t nextSeq = 1;
+    Clock::time_point nextAttempt;
+    int backoffMs = 0;
+    std::mt19937 jitter{std::random_device{}()};
+    uint64_t sentResults = 0, batches = 0, bytesSent = 0, bytesJson = 0, failures = 0;
+
+    void syncLoop()
+    {
+        loadOutbox();
+        nextAttempt = Clock::now();
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            auto deadline = outbox.empty() ? Clock::now() + std::chrono::hours(1) : nextAttempt;
+            wake.wait_until(lock, deadline, [this] { return !incoming.empty() || stopping; });
+            std::vector<ScoreResult> arrived;
+            arrived.swap(incoming);
+            bool stop = stopping;
+
+            lock.unlock();
+            if (!arrived.empty()) {
+                appendToOutbox(arrived);
+            }
+            if (stop) {
+                return;
+            }
+            if (!outbox.empty() && Clock::now() >= nextAttempt) {
+                sendBatch();
+            }
+            lock.lock();
+        }
+    }
+
+    void sendBatch()
+    {
+        size_t count = std::min(outbox.size(), SYNC_BATCH);
+        std::string json = batchJson(count);
+        std::vector<uint8_t> body;
+        zlibCompress(reinterpret_cast<const uint8_t*>(json.data()), json.size(), body);
+
+        int status = 0, retryAfter = 0;
+        std::string error = post(body, status, retryAfter);
+        if (error.empty() && status / 100 == 2) {
+            outbox.erase(outbox.begin(), outbox.begin() + count);
+            rewriteOutbox();
+            sentResults += count;
+            batches++;
+            bytesSent += body.size();
+            bytesJson += json.size();
+            backoffMs = 0;
+            nextAttempt = Clock::now();
+            return;
+        }
+        if (error.empty() && status / 100 == 4 && status != 408 && status != 429) {
+            // Resending would only be refused again.
+            std::cout << "Score sync: server refused " << count << " results with status " << status << ", dropping them" << std::endl;
+            outbox.erase(outbox.begin(), outbox.begin() + count);
+            rewriteOutbox();
+            return;
+        }
+
+        failures++;
+        backoffMs = backoffMs ? std::min(backoffMs * 2, SYNC_BACKOFF_MAX_MS) : SYNC_BACKOFF_MIN_MS;
+        int delayMs = backoffMs / 2 + (int)(jitter() % (backoffMs / 2 + 1));
+        delayMs = std::max(delayMs, std::min(retryAfter, SYNC_BACKOFF_MAX_MS / 1000) * 1000);
+        nextAttempt = Clock::now() + std::chrono::milliseconds(delayMs);
+        std::cout << "Score sync: " << (error.empty() ? "status " + std::to_string(status) : error) << ", " << outbox.size()
+                  << " results waiting, retrying in " << delayMs / 1000.0 << " s" << std::endl;
+    }
+
+    std::string batchJson(size_t count) const
+    {
+        std::ostringstream json;
+        json << "{\"kiosk\":\"";
+        for (char c : kioskId) {
+            if (c == '"' || c == '\\') {
+                json << '\\' << c;
+            } else if ((unsigned char)c >= 0x20) {
+                json << c;
+            }
+        }
+        json << "\",\"results\":[";
+        for (size_t i = 0; i < count; i++) {
+            const ScoreResult& r = outbox[i];
+            char hash[9];
+            snprintf(hash, sizeof(hash), "%08x", r.replayHash);
+            json << (i ? "," : "") << "{\"seq\":" << r.seq << ",\"score\":" << r.score << ",\"length\":" << r.length
+                 << ",\"duration_ms\":" << r.durationMs << ",\"replay_hash\":\"" << hash << "\",\"layout\":\""
+                 << (r.layout == LAYOUT_MAZE ? "maze" : "classic") << "\",\"ended_at\":" << r.endedAt << "}";
+        }
+        json << "]}";
+        return json.str();
+    }
+
+    // One HTTP/1.1 POST on a fresh connection; returns what went wrong, or
+    // an empty string and the response status.
+    std::string post(const std::vector<uint8_t>& body, int& status, int& retryAfter)
+    {
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* found = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0) {
+            return "cannot resolve " + host;
+        }
+        socket_t sock = (socket_t)-1;
+        for (addrinfo* a = found; a && sock == (socket_t)-1; a = a->ai_next) {
+            sock = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+            if (sock != (socket_t)-1 && !connectWithin(sock, a->ai_addr, (int)a->ai_addrlen)) {
+                closeSocket(sock);
+                sock = (socket_t)-1;
+            }
+        }
+        freeaddrinfo(found);
+        if (sock == (socket_t)-1) {
+            return "cannot connect to " + host + ":" + port;
+        }
+#ifdef _WIN32
+        DWORD timeout = SYNC_TIMEOUT_MS;
+#else
+        timeval timeout = {SYNC_TIMEOUT_MS / 1000, SYNC_TIMEOUT_MS % 1000 * 1000};
+#endif
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+
+        std::string request = "POST " + path + " HTTP/1.1\r\nHost: " + host + (port == "80" ? "" : ":" + port) +
+                              "\r\nUser-Agent: snake-score-sync/1\r\nContent-Type: application/json\r\n"
+                              "Content-Encoding: deflate\r\nContent-Length: " + std::to_string(body.size()) +
+                              "\r\nConnection: close\r\n\r\n";
+        request.append(body.begin(), body.end());
+        std::string response;
+        bool ok = sendAll(sock, request) && receive(sock, response);
+        closeSocket(sock);
+        if (!ok || sscanf(response.c_str(), "HTTP/1.%*d %d", &status) != 1) {
+            return "no response from " + host + ":" + port;
+        }
+        std::string headers = response;
+        std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+        size_t at = headers.find("\r\nretry-after:");
+        retryAfter = at == std::string::npos ? 0 : std::max(0, atoi(headers.c_str() + at + 14));
+        return "";
+    }
+
+    static bool connectWithin(socket_t sock, const sockaddr* addr, int length)
+    {
+        setNonBlocking(sock);
+        if (connect(sock, addr, length) != 0) {
+#ifdef _WIN32
+            if (WSAGetLastError() != WSAEWOULDBLOCK) {
+                return false;
+            }
+            fd_set writable, failed;
+            FD_ZERO(&writable);
+            FD_SET(sock, &writable);
+            FD_ZERO(&failed);
+            FD_SET(sock, &failed);
+            timeval tv = {SYNC_TIMEOUT_MS / 1000, SYNC_TIMEOUT_MS % 1000 * 1000};
+            if (select(0, nullptr, &writable, &failed, &tv) <= 0 || FD_ISSET(sock, &failed)) {
+                return false;
+            }
+#else
+            if (errno != EINPROGRESS) {
+                return false;
+            }
+            pollfd pfd = {sock, POLLOUT, 0};
+            int error = 0;
+            socklen_t size = sizeof(error);
+            if (poll(&pfd, 1, SYNC_TIMEOUT_MS) <= 0 || getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &size) != 0 || error != 0) {
+                return false;
+            }
+#endif
+        }
+        return setBlocking(sock);
+    }
+
+    static bool sendAll(socket_t sock, const std::string& data)
+    {
+#ifdef MSG_NOSIGNAL
+        const int flags = MSG_NOSIGNAL; // a server hanging up must not kill the game with SIGPIPE
+#else
+        const int flags = 0;
+#endif
+        size_t sent = 0;
+        while (sent < data.size()) {
+            int n = (int)send(sock, data.data() + sent, (int)(data.size() - sent), flags);
+            if (n <= 0) {
+                return false;
+            }
+            sent += n;
+        }
+        return true;
+    }
+
+    // Up to the end of the headers, or until the server closes.
+    static bool receive(socket_t sock, std::string& response)
+    {
+        char buffer[1024];
+        while (response.size() < SYNC_MAX_RESPONSE && response.find("\r\n\r\n") == std::string::npos) {
+            int n = (int)recv(sock, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                break;
+            }
+            response.append(buffer, n);
+        }
+        return !response.empty();
+    }
+
+    // Reads what earlier processes left undelivered. A record torn by a
+    // crash ends the outbox there; the file is rewritten without it.
+    void loadOutbox()
+    {
+        std::ifstream file(SYNC_OUTBOX_FILE, std::ios::binary);
+        if (!file.is_open()) {
+            return;
+        }
+        SyncOutboxHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != SYNC_MAGIC || header.version != SYNC_VERSION) {
+            std::cout << "Ignoring unreadable score outbox " << SYNC_OUTBOX_FILE << std::endl;
+            rewriteOutbox();
+            return;
+        }
+        nextSeq = std::max<uint64_t>(header.nextSeq, 1);
+        ScoreResult result;
+        uint32_t storedCrc;
+        while (file.read(reinterpret_cast<char*>(&result), sizeof(result)) &&
+               file.read(reinterpret_cast<char*>(&storedCrc), sizeof(storedCrc)) && crc32(&result, sizeof(result)) == storedCrc) {
+            outbox.push_back(result);
+            nextSeq = std::max(nextSeq, result.seq + 1);
+        }
+        file.clear();
+        file.seekg(0, std::ios::end);
+        if ((size_t)file.tellg() != sizeof(header) + outbox.size() * (sizeof(ScoreResult) + sizeof(uint32_t))) {
+            std::cout << "Score outbox " << SYNC_OUTBOX_FILE << " ends in a damaged record, keeping the " << outbox.size() << " before it"
+                      << std::endl;
+            rewriteOutbox();
+        }
+        if (!outbox.empty()) {
+            std::cout << "Score sync: " << outbox.size() << " results from earlier sessions waiting" << std::endl;
+        }
+    }
+
+    // Numbers the results and makes them durable before anything is sent.
+    void appendToOutbox(std::vector<ScoreResult>& results)
+    {
+        std::vector<char> bytes;
+        auto append = [&bytes](const void* data, size_t size) {
+            bytes.insert(bytes.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size);
+        };
+        struct stat info;
+        if (stat(SYNC_OUTBOX_FILE, &info) != 0 || info.st_size == 0) {
+            SyncOutboxHeader header = {SYNC_MAGIC, SYNC_VERSION, 0, nextSeq};
+            append(&header, sizeof(header));
+        }
+        for (ScoreResult& result : results) {
+            result.seq = nextSeq++;
+            uint32_t crc = crc32(&result, sizeof(result));
+            append(&result, sizeof(result));
+            append(&crc, sizeof(crc));
+            outbox.push_back(result);
+        }
+
+#ifdef _WIN32
+        int fd = _open(SYNC_OUTBOX_FILE, _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+        bool ok = fd >= 0 && _write(fd, bytes.data(), (unsigned)bytes.size()) == (int)bytes.size() && _commit(fd) == 0;
+        if (fd >= 0) {
+            _close(fd);
+        }
+#else
+        int fd = open(SYNC_OUTBOX_FILE, O_WRONLY | O_CREAT | O_APPEND, 0644);
+        bool ok = fd >= 0 && write(fd, bytes.data(), bytes.size()) == (ssize_t)bytes.size() && fsync(fd) == 0;
+        if (fd >= 0) {
+            close(fd);
+        }
+#endif
+        if (!ok) {
+            std::cout << "Error: Could not write score outbox " << SYNC_OUTBOX_FILE << std::endl;
+        }
+    }
+
+    // The whole outbox, as temp file -> fsync -> rename.
+    void rewriteOutbox()
+    {
+        SyncOutboxHeader header = {SYNC_MAGIC, SYNC_VERSION, 0, nextSeq};
+        std::vector<char> bytes(reinterpret_cast<const char*>(&header), reinterpret_cast<const char*>(&header) + sizeof(header));
+        for (const ScoreResult& result : outbox) {
+            uint32_t crc = crc32(&result, sizeof(result));
+            bytes.insert(bytes.end(), reinterpret_cast<const char*>(&result), reinterpret_cast<const char*>(&result) + sizeof(result));
+            bytes.insert(bytes.end(), reinterpret_cast<const char*>(&crc), reinterpret_cast<const char*>(&crc) + sizeof(crc));
+        }
+
+#ifdef _WIN32
+        int fd = _open(SYNC_OUTBOX_TEMP_FILE, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+        bool ok = fd >= 0 && _write(fd, bytes.data(), (unsigned)bytes.size()) == (int)bytes.size() && _commit(fd) == 0;
+        if (fd >= 0) {
+            _close(fd);
+        }
+        ok = ok && MoveFileExA(SYNC_OUTBOX_TEMP_FILE, SYNC_OUTBOX_FILE, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+        int fd = open(SYNC_OUTBOX_TEMP_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        bool ok = fd >= 0 && write(fd, bytes.data(), bytes.size()) == (ssize_t)bytes.size() && fsync(fd) == 0;
+        if (fd >= 0) {
+            close(fd);
+        }
+        ok = ok && rename(SYNC_OUTBOX_TEMP_FILE, SYNC_OUTBOX_FILE) == 0;
+#endif
+        if (!ok) {
+            std::cout << "Error: Could not write score outbox " << SYNC_OUTBOX_FILE << std::endl;
+        }
+    }
+};
+
+inline ScoreSync& scoreSync()
+{
+    static ScoreSync sync;
+    return sync;
+}
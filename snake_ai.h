@@ -0,0 +1,74 @@
+#pragma once
+
+// Cheap steering for computer-controlled snakes on a SnakeWorld. Every
+// decision is a fixed number of board lookups around the head, so a tick
+// with hundreds of AI snakes costs the same no matter how long they are.
+
+#include "snake_world.h"
+
+const int AI_FOOD_SAMPLES = 4;
+
+struct SnakeBrain {
+    int32_t target = -1;
+};
+
+inline int cellDistance(const SnakeWorld& world, int a, int b)
+{
+    return abs(world.cellX(a) - world.cellX(b)) + abs(world.cellY(a) - world.cellY(b));
+}
+
+// Picks the nearest of a few randomly sampled food cells.
+inline void pickTarget(const SnakeWorld& world, int head, SnakeBrain& brain, std::mt19937& rng)
+{
+    brain.target = -1;
+    int best = INT_MAX;
+    for (int i = 0; i < AI_FOOD_SAMPLES && !world.food.empty(); i++) {
+        int32_t cell = world.food[rng() % world.food.size()];
+        int d = cellDistance(world, head, cell);
+        if (d < best) {
+            best = d;
+            brain.target = cell;
+        }
+    }
+}
+
+inline int openNeighbours(const SnakeWorld& world, int cell)
+{
+    int n = 0;
+    for (int dir = 0; dir < 4; dir++) {
+        n += world.cellOwner(world.step(cell, dir)) == CELL_EMPTY;
+    }
+    return n;
+}
+
+// Chooses the next direction for snake id: the free neighbour closest to
+// its target, preferring cells with room around them.
+inline int steerSnake(const SnakeWorld& world, int id, SnakeBrain& brain, std::mt19937& rng)
+{
+    const WorldSnake& s = world.snakes[id];
+    int head = s.body.front();
+    if (brain.target < 0 || !world.hasFood(brain.target)) {
+        pickTarget(world, head, brain, rng);
+    }
+
+    int best = s.dir;
+    int bestScore = INT_MIN;
+    for (int dir = 0; dir < 4; dir++) {
+        if (isReverse(dir, s.dir)) {
+            continue;
+        }
+        int next = world.step(head, dir);
+        if (world.cellOwner(next) != CELL_EMPTY) {
+            continue;
+        }
+        int score = openNeighbours(world, next) * 8 + (int)(rng() % 3);
+        if (brain.target >= 0) {
+            score -= cellDistance(world, next, brain.target) * 2;
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            best = dir;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+// A single-player snake body on a grid of cellSize-pixel cells, kept as
+// linear cell indices (y * cols + x) plus a per-cell occupancy count, all
+// carved from the game arena. The occupancy grid makes the self-collision
+// test O(1) instead of a walk over the whole body. Moves and collisions
+// work on cell indices; Segment is each game's {x, y} in pixels and only
+// appears at the edges, for callers that place, draw or save the body.
+//
+// BODY_CELLS keeps every segment's cell, 4 bytes a segment. BODY_STEPS
+// keeps the head and tail cells and, for each segment, which of the four
+// neighbours the next one is in, 2 bits a segment, for boards where the
+// body's memory matters; every new head must then be a neighbour of the
+// old one (as every move in the games is), and indexing into the middle
+// walks from the nearer end, so whole-body passes use forEachCell.
+
+#include "arena.h"
+
+enum SnakeBodyMode : uint8_t {
+    BODY_CELLS = 0,
+    BODY_STEPS,
+};
+
+template <class Segment>
+class SnakeBody {
+public:
+    SnakeBody(Arena& arena, int cols, int rows, int cellSize, SnakeBodyMode mode = BODY_CELLS)
+        : mode(mode), capacity((size_t)cols * rows), cells(arena, mode == BODY_CELLS ? capacity : 0),
+          steps(mode == BODY_STEPS ? arena.allocate<uint8_t>(capacity / 4 + 1) : nullptr),
+          occupancy(arena.allocate<uint8_t>(capacity)), cols(cols), rows(rows), cellSize(cellSize),
+          stepDelta{1, -1, cols, -cols}
+    {
+    }
+
+    static size_t bytesFor(int cols, int rows, SnakeBodyMode mode)
+    {
+        size_t n = (size_t)cols * rows;
+        return n + (mode == BODY_CELLS ? n * sizeof(uint32_t) : n / 4 + 1) + 16;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    Segment operator[](size_t i) const
+    {
+        uint32_t c = cellAt(i);
+        return {(int)(c % cols) * cellSize, (int)(c / cols) * cellSize};
+    }
+
+    uint32_t cellAt(size_t i) const
+    {
+        if (mode == BODY_CELLS) {
+            return cells[i];
+        }
+        uint32_t c;
+        if (i <= count / 2) {
+            c = headCell;
+            for (size_t k = 0; k < i; k++) {
+                c += stepDelta[stepAt(k)];
+            }
+        } else {
+            c = tailCell;
+            for (size_t k = count - 1; k > i; k--) {
+                c -= stepDelta[stepAt(k - 1)];
+            }
+        }
+        return c;
+    }
+
+    // Calls f(cell) for every segment, head first.
+    template <class F>
+    void forEachCell(F f) const
+    {
+        if (mode == BODY_CELLS) {
+            for (size_t i = 0; i < count; i++) {
+                f(cells[i]);
+            }
+            return;
+        }
+        uint32_t c = headCell;
+        for (size_t k = 0; k < count; k++) {
+            f(c);
+            if (k + 1 < count) {
+                c += stepDelta[stepAt(k)];
+            }
+        }
+    }
+
+    // s must be on the board.
+    void pushFront(const Segment& s)
+    {
+        if (count == capacity) {
+            popBack();
+        }
+        int onBoard = cell(s);
+        if (onBoard < 0) {
+            std::cout << "Error: Snake segment " << s.x << "," << s.y << " is off the board" << std::endl;
+            exit(1);
+        }
+        uint32_t c = (uint32_t)onBoard;
+        if (mode == BODY_CELLS) {
+            cells.pushFront(c);
+        } else if (count == 0) {
+            headCell = tailCell = c;
+        } else {
+            int step = stepBetween(c, headCell);
+            first = (first + capacity - 1) % capacity;
+            steps[first / 4] = (uint8_t)((steps[first / 4] & ~(3 << (first % 4 * 2))) | step << (first % 4 * 2));
+            headCell = c;
+        }
+        count++;
+        occupancy[c]++;
+    }
+
+    void popBack()
+    {
+        if (count == 0) {
+            return;
+        }
+        occupancy[cellAt(count - 1)]--;
+        if (mode == BODY_CELLS) {
+            cells.popBack();
+        } else if (count > 1) {
+            tailCell -= stepDelta[stepAt(count - 2)];
+        }
+        count--;
+    }
+
+    // True if another segment shares the head's cell.
+    bool headHitsBody() const
+    {
+        return count > 0 && occupancy[cellAt(0)] > 1;
+    }
+
+    bool occupies(const Segment& s) const
+    {
+        int c = cell(s);
+        return c >= 0 && occupancy[c] > 0;
+    }
+
+    bool occupiesCell(uint32_t c) const
+    {
+        return occupancy[c] > 0;
+    }
+
+private:
+    SnakeBodyMode mode;
+    size_t capacity;
+    FixedRing<uint32_t> cells; // BODY_CELLS
+    uint8_t* steps;            // BODY_STEPS: step k, from segment k to k + 1, at ring position first + k
+    size_t first = 0;
+    uint32_t headCell = 0, tailCell = 0;
+    size_t count = 0;
+    uint8_t* occupancy;
+    int cols, rows, cellSize;
+    int32_t stepDelta[4]; // +x, -x, +y, -y as a change of cell index
+
+    int cell(const Segment& s) const
+    {
+        int x = s.x / cellSize, y = s.y / cellSize;
+        if (s.x < 0 || s.y < 0 || x >= cols || y >= rows) {
+            return -1;
+        }
+        return y * cols + x;
+    }
+
+    int stepAt(size_t k) const
+    {
+        size_t p = (first + k) % capacity;
+        return steps[p / 4] >> (p % 4 * 2) & 3;
+    }
+
+    int stepBetween(uint32_t from, uint32_t to) const
+    {
+        int dx = (int)(to % cols) - (int)(from % cols), dy = (int)(to / cols) - (int)(from / cols);
+        for (int step = 0; step < 4; step++) {
+            if (stepDelta[step] == dx + dy * cols && abs(dx) + abs(dy) == 1) {
+                return step;
+            }
+        }
+        std::cout << "Error: Snake body in step mode moved by " << dx << "," << dy << " cells" << std::endl;
+        exit(1);
+    }
+};
@@ -0,0 +1,70 @@
+#include <bits/stdc++.h>
+#include "snake_core.h"
+#include "stress.h"
+
+using namespace std;
+
+// Memory and speed of SnakeBody's two storage modes with a very long snake.
+//   snake_body_bench [--side N] [--length N] [--moves N]
+// The snake is laid along the Hamiltonian cycle of an N x N board
+// (1024 x 1024 inside the border by default, one pixel a cell) to the
+// given length, then circles it: every move pushes a head, drops the tail
+// and tests for a self-collision, as SnakeCore::tick does. A whole-body
+// walk, as the render snapshot does, is timed separately.
+
+int main(int argc, char* argv[])
+{
+    int side = 1024;
+    size_t length = 1000000, moves = 5000000;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cout << "Missing value for " << arg << endl;
+            return 1;
+        } else if (arg == "--side") {
+            side = max(2, atoi(argv[++i]) / 2 * 2);
+        } else if (arg == "--length") {
+            length = max(2, atoi(argv[++i]));
+        } else if (arg == "--moves") {
+            moves = max(1, atoi(argv[++i]));
+        } else {
+            cout << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    CoreRules rules = {side + 2, side + 2, 1, 5, 33, false};
+    vector<Segment> cycle = hamiltonianCycle(rules);
+    length = min(length, cycle.size() - 1);
+    int cols = rules.screenWidth, rows = rules.screenHeight;
+    cout << length << " segments on a " << side << "x" << side << " board; a ring of {x, y} pixel segments and the occupancy grid took "
+         << (size_t)cols * rows * (sizeof(Segment) + 1) << " bytes" << endl;
+
+    for (SnakeBodyMode mode : {BODY_CELLS, BODY_STEPS}) {
+        size_t bytes = SnakeBody<Segment>::bytesFor(cols, rows, mode);
+        Arena arena(bytes + 64);
+        SnakeBody<Segment> body(arena, cols, rows, 1, mode);
+        for (size_t i = 0; i < length; i++) {
+            body.pushFront(cycle[i]);
+        }
+
+        auto start = chrono::steady_clock::now();
+        size_t position = length - 1, hits = 0;
+        for (size_t m = 0; m < moves; m++) {
+            position = (position + 1) % cycle.size();
+            body.pushFront(cycle[position]);
+            body.popBack();
+            hits += body.headHitsBody();
+        }
+        double moveNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / moves;
+
+        start = chrono::steady_clock::now();
+        uint64_t sum = 0;
+        body.forEachCell([&](uint32_t cell) { sum += cell; });
+        double walkMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        cout << (mode == BODY_CELLS ? "cells" : "steps") << ": " << bytes << " bytes, " << fixed << setprecision(1) << moveNs
+             << " ns a move, " << walkMs << " ms a whole-body walk" << (hits ? ", collided!" : "") << (sum == 0 ? " (empty)" : "") << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include <bits/stdc++.h>
+#include "net_client.h"
+
+using namespace std;
+
+// Load-test client for snake_server: runs many bot players from one process.
+//   snake_bot [--host 127.0.0.1] [--port N] [--bots N] [--seconds S]
+// Each bot keeps its own replica from deltas, steers greedily towards food,
+// and the run ends with bandwidth per client and input latency percentiles.
+
+const int REPORT_EVERY_MS = 5000;
+const int HEARTBEAT_MS = 500;
+
+struct Bot {
+    NetClient client;
+    int lastDir = -1;
+    uint64_t lastSentUs = 0;
+};
+
+int currentDir(const BoardReplica& board, const ReplicaSnake& s)
+{
+    if (s.body.size() < 2) {
+        return DIR_RIGHT;
+    }
+    int d = s.body[0] - s.body[1];
+    return d == -board.width ? DIR_UP : d == 1 ? DIR_RIGHT : d == board.width ? DIR_DOWN : DIR_LEFT;
+}
+
+int freeNeighbours(const BoardReplica& board, int cell)
+{
+    int n = 0;
+    for (int dir = 0; dir < 4; dir++) {
+        n += board.owner[board.step(cell, dir)] == 0;
+    }
+    return n;
+}
+
+int chooseDirection(const BoardReplica& board, int id)
+{
+    const ReplicaSnake& s = board.snakes[id];
+    int head = s.body.front();
+    int dir = currentDir(board, s);
+    int hx = head % board.width, hy = head / board.width;
+
+    int best = dir;
+    int bestScore = INT_MIN;
+    for (int d = 0; d < 4; d++) {
+        if (isReverse(d, dir)) {
+            continue;
+        }
+        int next = board.step(head, d);
+        if (board.owner[next] != 0) {
+            continue;
+        }
+        int nx = next % board.width, ny = next / board.width;
+        int nearest = INT_MAX;
+        for (int32_t f : board.food) {
+            nearest = min(nearest, abs(f % board.width - nx) + abs(f / board.width - ny));
+        }
+        if (nearest == INT_MAX) {
+            nearest = abs(hx - nx) + abs(hy - ny);
+        }
+        int score = -nearest + freeNeighbours(board, next) * 4;
+        if (score > bestScore) {
+            bestScore = score;
+            best = d;
+        }
+    }
+    return best;
+}
+
+uint32_t percentile(vector<uint32_t>& samples, double p)
+{
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t k = min(samples.size() - 1, (size_t)(p * samples.size()));
+    nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+}
+
+void report(vector<unique_ptr<Bot>>& bots, double seconds)
+{
+    uint64_t down = 0, up = 0, resyncs = 0;
+    vector<uint32_t> latency;
+    for (auto& bot : bots) {
+        down += bot->client.stats.bytesReceived;
+        up += bot->client.stats.bytesSent;
+        resyncs += bot->client.stats.resyncs;
+        latency.insert(latency.end(), bot->client.stats.latencyUs.begin(), bot->client.stats.latencyUs.end());
+    }
+
+    double perClient = bots.empty() ? 0 : 1.0 / bots.size() / seconds / 1024.0;
+    cout << fixed << setprecision(2)
+         << bots.size() << " bots over " << seconds << " s: downlink " << down * perClient << " KiB/s per client, "
+         << "uplink " << up * perClient << " KiB/s per client, " << resyncs << " resync requests" << endl;
+
+    size_t samples = latency.size();
+    uint32_t p50 = percentile(latency, 0.50);
+    uint32_t p99 = percentile(latency, 0.99);
+    uint32_t worst = latency.empty() ? 0 : *max_element(latency.begin(), latency.end());
+    cout << "input latency (" << samples << " samples): p50 " << p50 / 1000.0 << " ms, p99 " << p99 / 1000.0
+         << " ms, max " << worst / 1000.0 << " ms" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    string host = "127.0.0.1";
+    int port = NET_DEFAULT_PORT, count = 64, seconds = 30;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--host") host = argv[i + 1];
+        else if (arg == "--port") port = atoi(argv[i + 1]);
+        else if (arg == "--bots") count = atoi(argv[i + 1]);
+        else if (arg == "--seconds") seconds = atoi(argv[i + 1]);
+        else {
+            cout << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    vector<unique_ptr<Bot>> bots;
+    for (int i = 0; i < count; i++) {
+        unique_ptr<Bot> bot(new Bot());
+        if (!bot->client.connect(host.c_str(), (uint16_t)port)) {
+            cout << "Bot " << i << " could not join" << endl;
+            break;
+        }
+        bots.push_back(move(bot));
+    }
+    if (bots.empty()) {
+        return 1;
+    }
+    cout << bots.size() << " bots joined a " << bots[0]->client.board.width << "x" << bots[0]->client.board.height
+         << " board at " << bots[0]->client.hz << " Hz" << endl;
+
+    uint64_t start = nowMicros();
+    uint64_t lastReport = start;
+    while (nowMicros() - start < (uint64_t)seconds * 1000000) {
+        for (auto& bot : bots) {
+            NetClient& c = bot->client;
+            int advanced = c.poll();
+            const ReplicaSnake& me = c.board.snakes[c.mySnake()];
+            uint64_t now = nowMicros();
+
+            int dir = bot->lastDir;
+            if (advanced > 0 && c.board.synced && me.alive && !me.body.empty()) {
+                dir = chooseDirection(c.board, c.mySnake());
+            }
+            if (dir >= 0 && (dir != bot->lastDir || now - bot->lastSentUs > HEARTBEAT_MS * 1000)) {
+                c.sendInput(dir);
+                bot->lastDir = dir;
+                bot->lastSentUs = now;
+            } else if (dir < 0 && now - bot->lastSentUs > HEARTBEAT_MS * 1000) {
+                c.sendInput(DIR_RIGHT);
+                bot->lastSentUs = now;
+            }
+        }
+
+        if (nowMicros() - lastReport > REPORT_EVERY_MS * 1000) {
+            report(bots, (nowMicros() - start) / 1e6);
+            lastReport = nowMicros();
+        }
+        this_thread::sleep_for(chrono::microseconds(500));
+    }
+
+    report(bots, (nowMicros() - start) / 1e6);
+    return 0;
+}
@@ -0,0 +1,165 @@
+    #include <SDL2/SDL.h>
+    #include <SDL2/SDL_image.h>
+    #include <SDL2/SDL_ttf.h>
+    #include <bits/stdc++.h>
+    #include "net_client.h"
+
+    using namespace std;
+
+    // Player client for snake_server: snake_client [host] [port]
+    // Arrow keys send direction intents; the board is drawn from the
+    // replica the server's deltas keep up to date.
+
+    const int SCREEN_WIDTH = 640;
+    const int SCREEN_HEIGHT = 480;
+
+    SDL_Texture* appleTexture = nullptr;
+    SDL_Texture* snakeHeadTexture = nullptr;
+
+    void renderText(SDL_Renderer* renderer, TTF_Font* font, const string& text, int x, int y);
+    SDL_Texture* loadTexture(SDL_Renderer* renderer, const char* path);
+    void renderBoard(SDL_Renderer* renderer, TTF_Font* font, const NetClient& client);
+
+    int main(int argc, char* argv[])
+    {
+        const char* host = argc > 1 ? argv[1] : "127.0.0.1";
+        uint16_t port = argc > 2 ? (uint16_t)atoi(argv[2]) : NET_DEFAULT_PORT;
+
+        NetClient client;
+        if (!client.connect(host, port)) {
+            return 1;
+        }
+
+        if (SDL_Init(SDL_INIT_VIDEO) < 0 || !(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) || TTF_Init() == -1) {
+            cout << "SDL could not initialize! SDL_Error: " << SDL_GetError() << endl;
+            return 1;
+        }
+
+        SDL_Window* window = SDL_CreateWindow("Snake Multiplayer", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                              SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+        SDL_Renderer* renderer = window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED) : nullptr;
+        TTF_Font* font = TTF_OpenFont("fonts/atop-font.ttf", 16);
+        if (!renderer || !font) {
+            cout << "Could not create window, renderer or font: " << SDL_GetError() << endl;
+            return 1;
+        }
+        appleTexture = loadTexture(renderer, "image/apple.png");
+        snakeHeadTexture = loadTexture(renderer, "image/snake_head.png");
+
+        bool quit = false;
+        while (!quit) {
+            SDL_Event event;
+            while (SDL_PollEvent(&event)) {
+                if (event.type == SDL_QUIT) {
+                    quit = true;
+                } else if (event.type == SDL_KEYDOWN) {
+                    switch (event.key.keysym.sym) {
+                        case SDLK_UP: client.sendInput(DIR_UP); break;
+                        case SDLK_DOWN: client.sendInput(DIR_DOWN); break;
+                        case SDLK_LEFT: client.sendInput(DIR_LEFT); break;
+                        case SDLK_RIGHT: client.sendInput(DIR_RIGHT); break;
+                        case SDLK_ESCAPE: quit = true; break;
+                    }
+                }
+            }
+
+            // Redraw only when the board moved; otherwise wait for the next packet.
+            if (client.poll() > 0) {
+                renderBoard(renderer, font, client);
+            } else {
+                client.wait(5);
+            }
+        }
+
+        client.leave();
+        SDL_DestroyTexture(appleTexture);
+        SDL_DestroyTexture(snakeHeadTexture);
+        TTF_CloseFont(font);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        TTF_Quit();
+        IMG_Quit();
+        SDL_Quit();
+        return 0;
+    }
+
+    SDL_Texture* loadTexture(SDL_Renderer* renderer, const char* path)
+    {
+        SDL_Surface* surface = IMG_Load(path);
+        if (!surface) {
+            cout << "Failed to load " << path << ": " << IMG_GetError() << endl;
+            return nullptr;
+        }
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+        SDL_FreeSurface(surface);
+        return texture;
+    }
+
+    void renderBoard(SDL_Renderer* renderer, TTF_Font* font, const NetClient& client)
+    {
+        const BoardReplica& board = client.board;
+        int cellSize = max(1, min(SCREEN_WIDTH / board.width, (SCREEN_HEIGHT - 20) / board.height));
+        int originX = (SCREEN_WIDTH - cellSize * board.width) / 2;
+        int originY = 20;
+        auto cellRect = [&](int cell) {
+            return SDL_Rect{originX + (cell % board.width) * cellSize, originY + (cell / board.width) * cellSize, cellSize, cellSize};
+        };
+
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+
+        SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
+        SDL_Rect walls[] = {
+            {originX, originY, board.width * cellSize, cellSize},
+            {originX, originY + (board.height - 1) * cellSize, board.width * cellSize, cellSize},
+            {originX, originY, cellSize, board.height * cellSize},
+            {originX + (board.width - 1) * cellSize, originY, cellSize, board.height * cellSize}
+        };
+        for (const auto& wall : walls) {
+            SDL_RenderFillRect(renderer, &wall);
+        }
+
+        for (int32_t cell : board.food) {
+            SDL_Rect rect = cellRect(cell);
+            SDL_RenderCopy(renderer, appleTexture, nullptr, &rect);
+        }
+
+        for (size_t id = 0; id < board.snakes.size(); id++) {
+            const ReplicaSnake& s = board.snakes[id];
+            if (!s.alive) {
+                continue;
+            }
+            if ((int)id == client.player) {
+                SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
+            } else {
+                SDL_SetRenderDrawColor(renderer, 80 + id * 53 % 176, 80 + id * 97 % 176, 80 + id * 31 % 176, 255);
+            }
+            for (size_t i = 1; i < s.body.size(); i++) {
+                SDL_Rect rect = cellRect(s.body[i]);
+                SDL_RenderFillRect(renderer, &rect);
+            }
+            SDL_Rect headRect = cellRect(s.body.front());
+            SDL_RenderCopy(renderer, snakeHeadTexture, nullptr, &headRect);
+        }
+
+        const ReplicaSnake& me = board.snakes[client.player];
+        string status = me.alive ? "Length: " + to_string(me.body.size()) : "Respawning...";
+        if (!client.stats.latencyUs.empty()) {
+            status += "   Input latency: " + to_string(client.stats.latencyUs.back() / 1000) + " ms";
+        }
+        renderText(renderer, font, status, 5, 0);
+
+        SDL_RenderPresent(renderer);
+    }
+
+    void renderText(SDL_Renderer* renderer, TTF_Font* font, const string& text, int x, int y) {
+        SDL_Color white = {255, 255, 255, 255};
+        SDL_Surface* textSurface = TTF_RenderText_Solid(font, text.c_str(), white);
+        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
+
+        SDL_Rect textRect = {x, y, textSurface->w, textSurface->h};
+        SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
+
+        SDL_FreeSurface(textSurface);
+        SDL_DestroyTexture(textTexture);
+    }
@@ -0,0 +1,393 @@
+#pragma once
+
+// The rules of main and task301 without SDL. tick() moves the snake one
+// cell, eats food and bonuses, spawns and expires bonuses and decides
+// deaths and (task301) maze pauses; what happened is reported as a list of
+// events the game turns into telemetry and sounds. Both games run it on
+// their simulation thread, and core_fuzz checks it tick by tick against
+// the plain model in core_reference.h.
+
+#include "snake_body.h"
+#include "entity_store.h"
+#include "timer_wheel.h"
+#include "telemetry.h"
+
+struct Segment {
+    int x, y;
+};
+
+struct CoreRules {
+    int screenWidth, screenHeight, cellSize;
+    int bonusEvery;  // foods eaten per bonus
+    int bonusTicks;  // how long a bonus stays
+    bool maze;       // task301: inner walls, leaving the middle pauses, bonuses move instead of expiring
+};
+
+const int CORE_FOOD_VALUE = 10;
+const int CORE_BONUS_VALUE = 50;
+const int CORE_CONTINUE_COST = 10;
+const int CORE_MAX_EVENTS = 8;
+const int CORE_TIMER_CAPACITY = 64;
+
+enum CoreTimerKind {
+    CORE_TIMER_BONUS_EXPIRE = 0,
+};
+
+// Deterministic and seedable, so a game can be replayed from its inputs.
+struct CoreRandom {
+    uint64_t state;
+
+    uint32_t next()
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (uint32_t)(state >> 33);
+    }
+};
+
+// Same fields as a telemetry event; type and cause use the telemetry codes.
+struct CoreEvent {
+    uint16_t type;
+    uint16_t cause;
+    int x, y;
+    int score;
+    int length;
+};
+
+inline bool operator==(const CoreEvent& a, const CoreEvent& b)
+{
+    return a.type == b.type && a.cause == b.cause && a.x == b.x && a.y == b.y && a.score == b.score && a.length == b.length;
+}
+
+// Everything tick() depends on apart from the rules and the body, for
+// saving a game and resuming it later.
+struct CoreState {
+    uint64_t random;
+    uint32_t tick;
+    int32_t score;
+    int32_t foodCounter;
+    bool paused;
+    Segment food;
+    bool bonusActive;
+    Segment bonus;
+    uint32_t bonusExpiresAt; // tick
+};
+
+// The walls of each layout, in pixels.
+inline int coreWalls(const CoreRules& rules, Segment* corners, Segment* sizes)
+{
+    int w = rules.screenWidth, h = rules.screenHeight, c = rules.cellSize;
+    const int walls[][4] = {
+        {0, 0, w, c},
+        {0, h - c, w, c},
+        {0, 0, c, h},
+        {w - c, 0, c, h},
+        {500, 80, 100, c},
+        {580, 80, c, 300},
+        {100, 80, c, 300},
+        {100, 380, 80, c},
+    };
+    int count = rules.maze ? 8 : 4;
+    for (int i = 0; i < count; i++) {
+        corners[i] = {walls[i][0], walls[i][1]};
+        sizes[i] = {walls[i][2], walls[i][3]};
+    }
+    return count;
+}
+
+class SnakeCore {
+public:
+    SnakeCore(Arena& arena, const CoreRules& rules, uint64_t seed, SnakeBodyMode bodyMode = BODY_CELLS)
+        : rules(rules), cols(rules.screenWidth / rules.cellSize), rows(rules.screenHeight / rules.cellSize),
+          snake(arena, cols, rows, rules.cellSize, bodyMode), store(arena, cols, rows, rules.cellSize, cols * rows)
+    {
+        random.state = seed;
+        timerNodes = arena.allocate<TimerNode>(CORE_TIMER_CAPACITY);
+        timers.reset(timerNodes, CORE_TIMER_CAPACITY);
+
+        Segment corners[8], sizes[8];
+        int walls = coreWalls(rules, corners, sizes);
+        for (int i = 0; i < walls; i++) {
+            store.spawn(ENTITY_WALL, corners[i].x, corners[i].y, sizes[i].x, sizes[i].y, 0);
+        }
+        snake.pushFront({rules.screenWidth / 2, rules.screenHeight / 2});
+        spawnFood();
+    }
+
+    static size_t bytesFor(const CoreRules& rules, SnakeBodyMode bodyMode = BODY_CELLS)
+    {
+        int cols = rules.screenWidth / rules.cellSize, rows = rules.screenHeight / rules.cellSize;
+        return SnakeBody<Segment>::bytesFor(cols, rows, bodyMode) + EntityStore::bytesFor(cols, rows, cols * rows) +
+               CORE_TIMER_CAPACITY * sizeof(TimerNode) + 64;
+    }
+
+    // dx, dy in pixels; continues is how many times the player chose to
+    // continue (task301) since the last tick.
+    void tick(int dx, int dy, int continues)
+    {
+        numEvents = 0;
+        movedThisTick = false;
+        for (int i = 0; i < continues; i++) {
+            if (paused) {
+                addEvent(EVENT_CONTINUE, 0, 0, points - CORE_CONTINUE_COST, 0);
+            }
+            paused = false;
+            points -= CORE_CONTINUE_COST;
+        }
+        if (finished || paused) {
+            return;
+        }
+        movedThisTick = true;
+
+        timers.advance([&](int kind, int data) {
+            if (kind == CORE_TIMER_BONUS_EXPIRE) {
+                expireBonus(data);
+            }
+        });
+        uint16_t deathCause = CAUSE_NONE;
+
+        snake.pushFront({snake[0].x + dx, snake[0].y + dy});
+        Segment head = snake[0];
+
+        bool foodEaten = false;
+        int hit = store.at(head.x, head.y);
+        int hitType = hit >= 0 ? store.columns().type[hit] : -1;
+        if (hitType == ENTITY_FOOD) {
+            foodEaten = true;
+            points += store.columns().value[hit];
+            foodCounter++;
+            addEvent(EVENT_FOOD_EATEN, store.x(hit), store.y(hit), points, (int)snake.size());
+            store.remove(foodId);
+
+            if (bonusId < 0 && foodCounter % rules.bonusEvery == 0) {
+                foodCounter = 0;
+                spawnBonus();
+            }
+        } else if (hitType == ENTITY_BONUS) {
+            points += store.columns().value[hit];
+            timers.cancel(bonusExpiry);
+            addEvent(EVENT_BONUS_EATEN, store.x(hit), store.y(hit), points, (int)snake.size());
+            store.remove(bonusId);
+            bonusId = -1;
+        } else {
+            snake.popBack();
+        }
+
+        if (snake.headHitsBody()) {
+            finished = true;
+            deathCause = CAUSE_SELF;
+            foodCounter = 0;
+        }
+
+        int c = rules.cellSize;
+        if (head.x < c || head.x >= rules.screenWidth - c || head.y < c || head.y >= rules.screenHeight - c) {
+            foodCounter = 0;
+            finished = true;
+            deathCause = CAUSE_BORDER_WALL;
+        }
+
+        if (rules.maze && (head.x < 100 || head.x >= 600 || head.y < c || head.y >= rules.screenHeight - c)) {
+            paused = true;
+            if (deathCause == CAUSE_NONE) {
+                deathCause = CAUSE_MAZE_WALL;
+            }
+        }
+
+        if (deathCause != CAUSE_NONE) {
+            addEvent(EVENT_DEATH, head.x, head.y, points, (int)snake.size(), deathCause);
+        }
+
+        if (foodEaten) {
+            spawnFood();
+        }
+    }
+
+    // Replaces the body with cells[0..length), head first; for setting up
+    // stress scenarios. Food and bonuses stay where they are.
+    void placeBody(const Segment* cells, int length)
+    {
+        while (snake.size() > 0) {
+            snake.popBack();
+        }
+        for (int i = length - 1; i >= 0; i--) {
+            snake.pushFront(cells[i]);
+        }
+    }
+
+    CoreState state() const
+    {
+        CoreState s = {};
+        s.random = random.state;
+        s.tick = timers.now();
+        s.score = points;
+        s.foodCounter = foodCounter;
+        s.paused = paused;
+        s.food = food();
+        s.bonusActive = bonusActive();
+        if (s.bonusActive) {
+            s.bonus = bonus();
+            s.bonusExpiresAt = store.columns().expiresAt[store.indexOf(bonusId)];
+        }
+        return s;
+    }
+
+    // Puts the core into a saved state (a save file, or an earlier tick
+    // for rewind); it then plays on exactly as the saved game would have.
+    void restore(const CoreState& s, const Segment* cells, int length)
+    {
+        finished = false;
+        movedThisTick = false;
+        numEvents = 0;
+        random.state = s.random;
+        timers.reset(timerNodes, CORE_TIMER_CAPACITY, s.tick);
+        points = s.score;
+        foodCounter = s.foodCounter;
+        paused = s.paused;
+        placeBody(cells, length);
+
+        store.remove(foodId);
+        store.remove(bonusId);
+        bonusId = -1;
+        foodId = store.spawn(ENTITY_FOOD, s.food.x, s.food.y, rules.cellSize, rules.cellSize, CORE_FOOD_VALUE);
+        if (s.bonusActive) {
+            bonusId = store.spawn(ENTITY_BONUS, s.bonus.x, s.bonus.y, rules.cellSize, rules.cellSize, CORE_BONUS_VALUE, s.bonusExpiresAt);
+            bonusExpiry = timers.schedule(s.bonusExpiresAt - s.tick, CORE_TIMER_BONUS_EXPIRE, bonusId);
+        }
+    }
+
+    // Dead by the border or its own body.
+    bool over() const
+    {
+        return finished;
+    }
+
+    bool isPaused() const
+    {
+        return paused;
+    }
+
+    // False if the last tick was skipped because the game is paused or over.
+    bool moved() const
+    {
+        return movedThisTick;
+    }
+
+    int score() const
+    {
+        return points;
+    }
+
+    const SnakeBody<Segment>& body() const
+    {
+        return snake;
+    }
+
+    const EntityStore& entities() const
+    {
+        return store;
+    }
+
+    Segment food() const
+    {
+        int i = store.indexOf(foodId);
+        return {store.x(i), store.y(i)};
+    }
+
+    bool bonusActive() const
+    {
+        return bonusId >= 0;
+    }
+
+    Segment bonus() const
+    {
+        int i = store.indexOf(bonusId);
+        return i >= 0 ? Segment{store.x(i), store.y(i)} : Segment{0, 0};
+    }
+
+    // What the last tick did, in order.
+    const CoreEvent* events() const
+    {
+        return eventList;
+    }
+
+    int eventCount() const
+    {
+        return numEvents;
+    }
+
+    const CoreRandom& rng() const
+    {
+        return random;
+    }
+
+    uint32_t ticksMoved() const
+    {
+        return timers.now();
+    }
+
+private:
+    CoreRules rules;
+    int cols, rows;
+    SnakeBody<Segment> snake;
+    EntityStore store;
+    TimerNode* timerNodes;
+    TimerWheel timers;
+    TimerId bonusExpiry;
+    CoreRandom random;
+    int foodId = -1;
+    int bonusId = -1; // -1 while no bonus is on the board
+    int foodCounter = 0;
+    int points = 0;
+    bool paused = false;
+    bool finished = false;
+    bool movedThisTick = false;
+    CoreEvent eventList[CORE_MAX_EVENTS];
+    int numEvents = 0;
+
+    void addEvent(uint16_t type, int x, int y, int score, int length, uint16_t cause = CAUSE_NONE)
+    {
+        if (numEvents < CORE_MAX_EVENTS) {
+            eventList[numEvents++] = {type, cause, x, y, score, length};
+        }
+    }
+
+    // A random cell inside the border that no entity covers.
+    Segment freeCell()
+    {
+        int c = rules.cellSize;
+        Segment cell;
+        do {
+            cell.x = random.next() % ((rules.screenWidth - 4 * c) / c) * c + c;
+            cell.y = random.next() % ((rules.screenHeight - 4 * c) / c) * c + c;
+        } while (store.at(cell.x, cell.y) >= 0);
+        return cell;
+    }
+
+    void spawnFood()
+    {
+        Segment cell = freeCell();
+        foodId = store.spawn(ENTITY_FOOD, cell.x, cell.y, rules.cellSize, rules.cellSize, CORE_FOOD_VALUE);
+    }
+
+    void spawnBonus()
+    {
+        Segment cell = freeCell();
+        bonusId = store.spawn(ENTITY_BONUS, cell.x, cell.y, rules.cellSize, rules.cellSize, CORE_BONUS_VALUE,
+                              timers.now() + rules.bonusTicks);
+        addEvent(EVENT_BONUS_SPAWN, cell.x, cell.y, points, (int)snake.size());
+        bonusExpiry = timers.schedule(rules.bonusTicks, CORE_TIMER_BONUS_EXPIRE, bonusId);
+    }
+
+    // The bonus was not eaten in time: it vanishes, or in the maze moves
+    // somewhere else.
+    void expireBonus(int id)
+    {
+        int i = store.indexOf(id);
+        addEvent(EVENT_BONUS_EXPIRE, store.x(i), store.y(i), points, (int)snake.size());
+        store.remove(id);
+        bonusId = -1;
+        if (rules.maze) {
+            foodCounter = 0;
+            spawnBonus();
+        }
+    }
+};
@@ -0,0 +1,299 @@
+#include <bits/stdc++.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+#include "snake_env.h"
+#include "snake_core.h"
+
+using namespace std;
+
+// The batched training environment declared in snake_env.h, built as a
+// shared library (snake_env.dll / libsnake_env.so) for trainers to load.
+
+// The rules of main and task301.
+const CoreRules ENV_RULES[] = {
+    {640, 480, 20, 5, 4000 / 120, false},
+    {640, 480, 20, 2, 4000 / 120, true},
+};
+const int ENV_STEPS[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}}; // by SnakeEnvAction
+
+struct EnvGame {
+    Arena arena;
+    optional<SnakeCore> core;
+    uint8_t direction = SNAKE_ENV_RIGHT;
+    int sinceScore = 0; // moves since the score last changed
+
+    explicit EnvGame(size_t bytes) : arena(bytes) {}
+};
+
+struct SnakeEnv {
+    CoreRules rules;
+    int envs, cols, rows, cells;
+    uint8_t* buffer = nullptr;
+    vector<uint64_t> ownBuffer; // when neither the caller nor shared memory holds it
+    string sharedName;
+    size_t sharedBytes = 0;
+#ifdef _WIN32
+    HANDLE mapping = nullptr;
+#endif
+    SnakeEnvHeader* header = nullptr;
+    uint8_t* observations = nullptr;
+    float* rewards = nullptr;
+    uint8_t* dones = nullptr;
+    vector<uint8_t> walls; // the wall plane, the same for every game
+    vector<unique_ptr<EnvGame>> games;
+    uint64_t nextSeed = 0;
+
+    int cellOf(const Segment& s) const
+    {
+        return s.y / rules.cellSize * cols + s.x / rules.cellSize;
+    }
+
+    uint8_t* planes(int game, int plane)
+    {
+        return observations + ((size_t)game * SNAKE_ENV_PLANES + plane) * cells;
+    }
+
+    void resetGame(int i, uint64_t seed)
+    {
+        EnvGame& g = *games[i];
+        g.arena.reset();
+        g.core.emplace(g.arena, rules, seed);
+        g.direction = SNAKE_ENV_RIGHT;
+        g.sinceScore = 0;
+
+        const SnakeCore& core = *g.core;
+        memset(planes(i, 0), 0, (size_t)SNAKE_ENV_PLANES * cells);
+        memcpy(planes(i, SNAKE_ENV_WALL), walls.data(), cells);
+        uint8_t* body = planes(i, SNAKE_ENV_BODY);
+        core.body().forEachCell([&](uint32_t cell) { body[cell] = 1; });
+        planes(i, SNAKE_ENV_HEAD)[core.body().cellAt(0)] = 1;
+        planes(i, SNAKE_ENV_FOOD)[cellOf(core.food())] = 1;
+        if (core.bonusActive()) {
+            planes(i, SNAKE_ENV_BONUS)[cellOf(core.bonus())] = 1;
+        }
+    }
+};
+
+static size_t alignUp(size_t n)
+{
+    return (n + 63) & ~(size_t)63;
+}
+
+size_t snake_env_bytes(int envs, int layout)
+{
+    if (envs <= 0 || layout < SNAKE_ENV_CLASSIC || layout > SNAKE_ENV_MAZE) {
+        return 0;
+    }
+    const CoreRules& rules = ENV_RULES[layout];
+    size_t cells = (size_t)(rules.screenWidth / rules.cellSize) * (rules.screenHeight / rules.cellSize);
+    return alignUp(sizeof(SnakeEnvHeader)) + alignUp((size_t)envs * SNAKE_ENV_PLANES * cells) + alignUp(envs * sizeof(float)) +
+           alignUp(envs);
+}
+
+// Lays the header and the arrays out over env->buffer and starts every game.
+static SnakeEnv* start(SnakeEnv* env, int envs, int layout)
+{
+    env->rules = ENV_RULES[layout];
+    env->envs = envs;
+    env->cols = env->rules.screenWidth / env->rules.cellSize;
+    env->rows = env->rules.screenHeight / env->rules.cellSize;
+    env->cells = env->cols * env->rows;
+
+    size_t observations = alignUp(sizeof(SnakeEnvHeader));
+    size_t rewards = observations + alignUp((size_t)envs * SNAKE_ENV_PLANES * env->cells);
+    size_t dones = rewards + alignUp(envs * sizeof(float));
+    env->header = reinterpret_cast<SnakeEnvHeader*>(env->buffer);
+    *env->header = {SNAKE_ENV_MAGIC, SNAKE_ENV_VERSION, (uint32_t)envs, SNAKE_ENV_PLANES, (uint32_t)env->cols, (uint32_t)env->rows,
+                    observations, rewards, dones, 0};
+    env->observations = env->buffer + observations;
+    env->rewards = reinterpret_cast<float*>(env->buffer + rewards);
+    env->dones = env->buffer + dones;
+
+    env->walls.assign(env->cells, 0);
+    Segment corners[8], sizes[8];
+    int walls = coreWalls(env->rules, corners, sizes);
+    int c = env->rules.cellSize;
+    for (int w = 0; w < walls; w++) {
+        for (int y = corners[w].y / c; y < (corners[w].y + sizes[w].y) / c; y++) {
+            for (int x = corners[w].x / c; x < (corners[w].x + sizes[w].x) / c; x++) {
+                env->walls[y * env->cols + x] = 1;
+            }
+        }
+    }
+
+    for (int i = 0; i < envs; i++) {
+        env->games.push_back(make_unique<EnvGame>(SnakeCore::bytesFor(env->rules) + 256));
+    }
+    snake_env_reset(env, 0);
+    return env;
+}
+
+SnakeEnv* snake_env_create(int envs, int layout, void* buffer)
+{
+    size_t bytes = snake_env_bytes(envs, layout);
+    if (bytes == 0) {
+        return nullptr;
+    }
+    SnakeEnv* env = new SnakeEnv();
+    if (buffer) {
+        env->buffer = static_cast<uint8_t*>(buffer);
+    } else {
+        env->ownBuffer.resize(bytes / sizeof(uint64_t));
+        env->buffer = reinterpret_cast<uint8_t*>(env->ownBuffer.data());
+    }
+    return start(env, envs, layout);
+}
+
+SnakeEnv* snake_env_create_shared(int envs, int layout, const char* name)
+{
+    size_t bytes = snake_env_bytes(envs, layout);
+    if (bytes == 0 || !name) {
+        return nullptr;
+    }
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)bytes >> 32), (DWORD)bytes, name);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes) : nullptr;
+    if (!view) {
+        cout << "Error: Could not map shared memory " << name << endl;
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        return nullptr;
+    }
+#else
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0600);
+    void* view = MAP_FAILED;
+    if (fd >= 0 && ftruncate(fd, bytes) == 0) {
+        view = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (view == MAP_FAILED) {
+        cout << "Error: Could not map shared memory " << name << ": " << strerror(errno) << endl;
+        shm_unlink(name);
+        return nullptr;
+    }
+#endif
+    SnakeEnv* env = new SnakeEnv();
+    env->buffer = static_cast<uint8_t*>(view);
+    env->sharedName = name;
+    env->sharedBytes = bytes;
+#ifdef _WIN32
+    env->mapping = mapping;
+#endif
+    return start(env, envs, layout);
+}
+
+void snake_env_destroy(SnakeEnv* env)
+{
+    if (!env) {
+        return;
+    }
+    if (!env->sharedName.empty()) {
+#ifdef _WIN32
+        UnmapViewOfFile(env->buffer);
+        CloseHandle(env->mapping);
+#else
+        munmap(env->buffer, env->sharedBytes);
+        shm_unlink(env->sharedName.c_str());
+#endif
+    }
+    delete env;
+}
+
+void snake_env_reset(SnakeEnv* env, uint64_t seed)
+{
+    for (int i = 0; i < env->envs; i++) {
+        env->resetGame(i, seed + i);
+        env->rewards[i] = 0;
+        env->dones[i] = SNAKE_ENV_RUNNING;
+    }
+    env->nextSeed = seed + env->envs;
+}
+
+void snake_env_step(SnakeEnv* env, const uint8_t* actions)
+{
+    int c = env->rules.cellSize;
+    for (int i = 0; i < env->envs; i++) {
+        EnvGame& g = *env->games[i];
+        SnakeCore& core = *g.core;
+        const SnakeBody<Segment>& body = core.body();
+        if (actions[i] <= SNAKE_ENV_LEFT && (body.size() == 1 || (actions[i] ^ g.direction) != 2)) {
+            g.direction = actions[i];
+        }
+
+        uint32_t head = body.cellAt(0);
+        uint32_t tail = body.cellAt(body.size() - 1);
+        size_t length = body.size();
+        int food = env->cellOf(core.food());
+        int bonus = core.bonusActive() ? env->cellOf(core.bonus()) : -1;
+        int score = core.score();
+        core.tick(ENV_STEPS[g.direction][0] * c, ENV_STEPS[g.direction][1] * c, 0);
+
+        float reward = (float)(core.score() - score) / CORE_FOOD_VALUE;
+        uint8_t done = SNAKE_ENV_RUNNING;
+        if (core.over() || core.isPaused()) {
+            reward -= 1;
+            done = SNAKE_ENV_TERMINATED;
+        } else if (core.score() != score) {
+            g.sinceScore = 0;
+        } else if (++g.sinceScore >= env->cells) {
+            done = SNAKE_ENV_TRUNCATED;
+        }
+        env->rewards[i] = reward;
+        env->dones[i] = done;
+        if (done != SNAKE_ENV_RUNNING) {
+            env->resetGame(i, env->nextSeed++);
+            continue;
+        }
+
+        // The tail goes before the head is drawn, which may have moved
+        // into the cell the tail just left.
+        uint32_t newHead = body.cellAt(0);
+        if (body.size() == length) {
+            env->planes(i, SNAKE_ENV_BODY)[tail] = 0;
+        }
+        env->planes(i, SNAKE_ENV_BODY)[newHead] = 1;
+        env->planes(i, SNAKE_ENV_HEAD)[head] = 0;
+        env->planes(i, SNAKE_ENV_HEAD)[newHead] = 1;
+        env->planes(i, SNAKE_ENV_FOOD)[food] = 0;
+        env->planes(i, SNAKE_ENV_FOOD)[env->cellOf(core.food())] = 1;
+        if (bonus >= 0) {
+            env->planes(i, SNAKE_ENV_BONUS)[bonus] = 0;
+        }
+        if (core.bonusActive()) {
+            env->planes(i, SNAKE_ENV_BONUS)[env->cellOf(core.bonus())] = 1;
+        }
+    }
+    // A reader in another process sees steps change only once the step
+    // is fully written.
+    atomic_thread_fence(memory_order_release);
+    env->header->steps++;
+}
+
+SnakeEnvHeader* snake_env_header(SnakeEnv* env)
+{
+    return env->header;
+}
+
+uint8_t* snake_env_observations(SnakeEnv* env)
+{
+    return env->observations;
+}
+
+float* snake_env_rewards(SnakeEnv* env)
+{
+    return env->rewards;
+}
+
+uint8_t* snake_env_dones(SnakeEnv* env)
+{
+    return env->dones;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+/* Batched training environment over SnakeCore, as a C API. One SnakeEnv
+ * runs a batch of single-player games in lockstep and writes everything a
+ * trainer reads into one contiguous buffer: a SnakeEnvHeader, then the
+ * observations (per game, five planes of rows x cols bytes, 1 where the
+ * plane's thing is), then a float reward and a done byte per game. The
+ * planes are updated in place from what each tick changed (the cell the
+ * head entered, the tail cell it left, food and bonus moves), so a step
+ * copies nothing; a game is only redrawn in full when it resets.
+ *
+ * The buffer can be the caller's (snake_env_bytes long, 8-byte aligned),
+ * or placed in POSIX shared memory (a named file mapping on Windows) so a
+ * trainer in another process can map it by name and read it in place; the
+ * header says where everything is, and steps is bumped after each step is
+ * written. For more than one core, create one SnakeEnv per thread, each
+ * over its own buffer or its own slice of a larger one.
+ *
+ * Games that end are reset straight away with the next seed, so the
+ * observation after a done step is the start of the next game. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+    #define SNAKE_ENV_API __declspec(dllexport)
+#else
+    #define SNAKE_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNAKE_ENV_MAGIC 0x564E4553u /* "SENV" */
+#define SNAKE_ENV_VERSION 1
+
+enum SnakeEnvLayout {
+    SNAKE_ENV_CLASSIC = 0, /* main's board */
+    SNAKE_ENV_MAZE,        /* task301's, where leaving the middle ends the game */
+};
+
+enum SnakeEnvPlane {
+    SNAKE_ENV_BODY = 0, /* every segment, head included */
+    SNAKE_ENV_HEAD,
+    SNAKE_ENV_FOOD,
+    SNAKE_ENV_BONUS,
+    SNAKE_ENV_WALL,
+    SNAKE_ENV_PLANES,
+};
+
+/* Actions, as in snake_world.h; turning back onto the body is ignored. */
+enum SnakeEnvAction {
+    SNAKE_ENV_UP = 0,
+    SNAKE_ENV_RIGHT,
+    SNAKE_ENV_DOWN,
+    SNAKE_ENV_LEFT,
+};
+
+enum SnakeEnvDone {
+    SNAKE_ENV_RUNNING = 0,
+    SNAKE_ENV_TERMINATED, /* died, or left the maze's middle */
+    SNAKE_ENV_TRUNCATED,  /* went rows x cols moves without scoring */
+};
+
+typedef struct SnakeEnvHeader {
+    uint32_t magic, version;
+    uint32_t envs, planes, cols, rows;
+    uint64_t observations; /* byte offsets from the start of the header */
+    uint64_t rewards;      /* float per game: +1 a food, +5 a bonus, -1 on termination */
+    uint64_t dones;        /* uint8_t per game, a SnakeEnvDone */
+    uint64_t steps;
+} SnakeEnvHeader;
+
+typedef struct SnakeEnv SnakeEnv;
+
+SNAKE_ENV_API size_t snake_env_bytes(int envs, int layout);
+
+/* buffer may be NULL to have the environment allocate its own. NULL if
+ * layout or envs is out of range. */
+SNAKE_ENV_API SnakeEnv* snake_env_create(int envs, int layout, void* buffer);
+
+/* As above, with the buffer in shared memory called name (e.g.
+ * "/snake-env"), which is removed again by snake_env_destroy. */
+SNAKE_ENV_API SnakeEnv* snake_env_create_shared(int envs, int layout, const char* name);
+
+SNAKE_ENV_API void snake_env_destroy(SnakeEnv* env);
+
+/* Starts every game over, game i from seed + i. */
+SNAKE_ENV_API void snake_env_reset(SnakeEnv* env, uint64_t seed);
+
+/* One tick of every game; actions holds one SnakeEnvAction per game. */
+SNAKE_ENV_API void snake_env_step(SnakeEnv* env, const uint8_t* actions);
+
+SNAKE_ENV_API SnakeEnvHeader* snake_env_header(SnakeEnv* env);
+SNAKE_ENV_API uint8_t* snake_env_observations(SnakeEnv* env);
+SNAKE_ENV_API float* snake_env_rewards(SnakeEnv* env);
+SNAKE_ENV_API uint8_t* snake_env_dones(SnakeEnv* env);
+
+#ifdef __cplusplus
+}
+#endif
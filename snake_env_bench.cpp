@@ -0,0 +1,87 @@
+#include <bits/stdc++.h>
+#include "snake_env.h"
+
+using namespace std;
+
+// Throughput of the batched training environment in snake_env.h.
+//   snake_env_bench [--envs N] [--steps N] [--layout classic|maze] [--threads N] [--shared NAME]
+// Every thread steps its own batch of N games (in shared memory named
+// NAME-<thread> with --shared) with a player that mostly goes straight
+// and sometimes turns at random, and the total env-steps a second are
+// printed with how many games ended.
+
+int main(int argc, char* argv[])
+{
+    int envs = 256, steps = 20000, layout = SNAKE_ENV_CLASSIC;
+    int threads = max(1u, thread::hardware_concurrency());
+    string shared;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cout << "Missing value for " << arg << endl;
+            return 1;
+        } else if (arg == "--envs") {
+            envs = max(1, atoi(argv[++i]));
+        } else if (arg == "--steps") {
+            steps = max(1, atoi(argv[++i]));
+        } else if (arg == "--layout") {
+            layout = string(argv[++i]) == "maze" ? SNAKE_ENV_MAZE : SNAKE_ENV_CLASSIC;
+        } else if (arg == "--threads") {
+            threads = max(1, atoi(argv[++i]));
+        } else if (arg == "--shared") {
+            shared = argv[++i];
+        } else {
+            cout << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    cout << "Stepping " << threads << " x " << envs << " games for " << steps << " steps, "
+         << snake_env_bytes(envs, layout) << " bytes a batch" << endl;
+    atomic<uint64_t> episodes{0};
+    atomic<bool> failed{false};
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            SnakeEnv* env = shared.empty() ? snake_env_create(envs, layout, nullptr)
+                                           : snake_env_create_shared(envs, layout, (shared + "-" + to_string(t)).c_str());
+            if (!env) {
+                failed = true;
+                return;
+            }
+            snake_env_reset(env, (uint64_t)t * 1000003);
+            vector<uint8_t> actions(envs, SNAKE_ENV_RIGHT);
+            uint32_t random = 2463534242u + t;
+            uint64_t ended = 0;
+            const uint8_t* dones = snake_env_dones(env);
+            for (int s = 0; s < steps; s++) {
+                for (int i = 0; i < envs; i++) {
+                    random ^= random << 13;
+                    random ^= random >> 17;
+                    random ^= random << 5;
+                    if ((random & 7) == 0) {
+                        actions[i] = (uint8_t)(random >> 8 & 3);
+                    }
+                }
+                snake_env_step(env, actions.data());
+                for (int i = 0; i < envs; i++) {
+                    ended += dones[i] != SNAKE_ENV_RUNNING;
+                }
+            }
+            episodes += ended;
+            snake_env_destroy(env);
+        });
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    if (failed) {
+        return 1;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    double total = (double)threads * envs * steps;
+    cout << fixed << setprecision(0) << total << " env-steps in " << setprecision(2) << seconds << " s: " << setprecision(0)
+         << total / seconds << " env-steps/s, " << episodes << " games ended" << endl;
+    return 0;
+}
@@ -0,0 +1,358 @@
+#include <bits/stdc++.h>
+#include <csignal>
+#include "net_protocol.h"
+
+using namespace std;
+
+// Headless authoritative server for the multiplayer board.
+//   snake_server [--port N] [--hz N] [--width W] [--height H] [--food N] [--seconds S]
+// Steps one SnakeWorld at a fixed tick and sends each client a delta per
+// tick. Use --hz 8 for human players; bots are happy at the default 60.
+
+const int HEADER_SIZE = 1 + 4 + 4 + 8; // type, tick, ackSeq, echoUs
+const int REPORT_EVERY_MS = 5000;
+
+struct ClientSlot {
+    bool active = false;
+    sockaddr_in addr;
+    uint32_t nonce = 0;
+    uint64_t lastHeardUs = 0;
+
+    bool hasInput = false;
+    uint8_t inputDir = 0;
+    uint32_t inputSeq = 0;
+    uint64_t inputSentUs = 0;
+    uint32_t ackSeq = 0;
+    uint64_t echoUs = 0;
+
+    uint32_t respawnAt = 0;
+    bool wantsKeyframe = true;
+    uint64_t bytesSent = 0;
+};
+
+volatile sig_atomic_t running = 1;
+
+void stopServer(int)
+{
+    running = 0;
+}
+
+bool sameAddr(const sockaddr_in& a, const sockaddr_in& b)
+{
+    return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+}
+
+class SnakeServer {
+public:
+    SnakeServer(int width, int height, int food, int hz)
+        : world(width, height, food, (uint32_t)time(nullptr)), hz(hz), clients(NET_MAX_PLAYERS)
+    {
+        for (int i = 0; i < NET_MAX_PLAYERS; i++) {
+            world.addSnake();
+        }
+        world.refillFood();
+        world.delta.clear();
+    }
+
+    bool listen(uint16_t port)
+    {
+        if (!socketsInit()) {
+            return false;
+        }
+        sock = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+        if (sock == (socket_t)-1 || bind(sock, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            cout << "Could not bind UDP port " << port << endl;
+            return false;
+        }
+        setNonBlocking(sock);
+        return true;
+    }
+
+    void run(int seconds)
+    {
+        const uint64_t period = 1000000 / hz;
+        uint64_t start = nowMicros();
+        uint64_t nextTick = start + period;
+        lastReportUs = start;
+
+        while (running && (seconds <= 0 || nowMicros() - start < (uint64_t)seconds * 1000000)) {
+            uint64_t now = nowMicros();
+            if (now < nextTick) {
+                waitReadable((int)((nextTick - now + 999) / 1000));
+                receiveAll();
+                continue;
+            }
+
+            receiveAll();
+            tick();
+
+            nextTick += period;
+            if (nowMicros() > nextTick + period * 5) {
+                lateTicks++;
+                nextTick = nowMicros() + period; // fell far behind: do not try to catch up
+            }
+            if (nowMicros() - lastReportUs >= REPORT_EVERY_MS * 1000) {
+                report();
+            }
+        }
+        report();
+        closeSocket(sock);
+    }
+
+private:
+    SnakeWorld world;
+    int hz;
+    vector<ClientSlot> clients;
+    socket_t sock = (socket_t)-1;
+
+    uint64_t lastReportUs = 0;
+    uint64_t reportTicks = 0;
+    uint64_t reportStepUs = 0;
+    uint64_t reportTickUs = 0;
+    uint64_t reportMaxTickUs = 0;
+    uint64_t reportBytes = 0;
+    uint64_t lateTicks = 0;
+
+    void waitReadable(int timeoutMs)
+    {
+#ifdef _WIN32
+        fd_set set;
+        FD_ZERO(&set);
+        FD_SET(sock, &set);
+        timeval tv = {0, timeoutMs * 1000};
+        select(0, &set, nullptr, nullptr, &tv);
+#else
+        pollfd pfd = {sock, POLLIN, 0};
+        poll(&pfd, 1, timeoutMs);
+#endif
+    }
+
+    void sendTo(ClientSlot& c, const uint8_t* data, int size)
+    {
+        sendto(sock, (const char*)data, size, 0, (const sockaddr*)&c.addr, sizeof(c.addr));
+        c.bytesSent += size;
+        reportBytes += size;
+    }
+
+    void receiveAll()
+    {
+        uint8_t buf[NET_MAX_PACKET];
+        sockaddr_in from;
+        socklen_t len = sizeof(from);
+        int n;
+        while ((n = recvfrom(sock, (char*)buf, sizeof(buf), 0, (sockaddr*)&from, &len)) > 0) {
+            handlePacket(buf, n, from);
+            len = sizeof(from);
+        }
+    }
+
+    void handlePacket(const uint8_t* data, int size, const sockaddr_in& from)
+    {
+        PacketReader in(data, size);
+        uint8_t type = in.get8();
+
+        if (type == PACKET_JOIN) {
+            uint32_t nonce = in.get32();
+            if (in.ok()) {
+                join(nonce, from);
+            }
+            return;
+        }
+
+        uint8_t player = in.get8();
+        if (!in.ok() || player >= clients.size() || !clients[player].active || !sameAddr(clients[player].addr, from)) {
+            return;
+        }
+        ClientSlot& c = clients[player];
+        c.lastHeardUs = nowMicros();
+
+        if (type == PACKET_INPUT) {
+            uint32_t seq = in.get32();
+            uint8_t dir = in.get8();
+            uint64_t sentUs = in.get64();
+            if (in.ok() && seq > c.inputSeq) {
+                c.hasInput = true;
+                c.inputDir = dir & 3;
+                c.inputSeq = seq;
+                c.inputSentUs = sentUs;
+            }
+        } else if (type == PACKET_RESYNC) {
+            c.wantsKeyframe = true;
+        } else if (type == PACKET_LEAVE) {
+            dropClient(player);
+        }
+    }
+
+    void join(uint32_t nonce, const sockaddr_in& from)
+    {
+        int slot = -1;
+        for (size_t i = 0; i < clients.size(); i++) {
+            if (clients[i].active && clients[i].nonce == nonce && sameAddr(clients[i].addr, from)) {
+                slot = (int)i; // a resent JOIN whose WELCOME was lost
+                break;
+            }
+        }
+        for (size_t i = 0; i < clients.size() && slot < 0; i++) {
+            if (!clients[i].active && !world.snakes[i].alive) {
+                slot = (int)i;
+                clients[i] = ClientSlot();
+                clients[i].active = true;
+                clients[i].addr = from;
+                clients[i].nonce = nonce;
+                // Two ticks out, so the spawn never shares a delta with the
+                // death of whoever held this slot before.
+                clients[i].respawnAt = world.tick + 2;
+                cout << "Player " << i << " joined from " << inet_ntoa(from.sin_addr) << ":" << ntohs(from.sin_port) << endl;
+            }
+        }
+
+        PacketWriter w;
+        if (slot < 0) {
+            w.put8(PACKET_FULL);
+            sendto(sock, (const char*)w.data, w.size, 0, (const sockaddr*)&from, sizeof(from));
+            return;
+        }
+        ClientSlot& c = clients[slot];
+        c.lastHeardUs = nowMicros();
+        w.put8(PACKET_WELCOME);
+        w.put32(nonce);
+        w.put8((uint8_t)slot);
+        w.put16((uint16_t)world.width);
+        w.put16((uint16_t)world.height);
+        w.put16((uint16_t)hz);
+        sendTo(c, w.data, w.size);
+    }
+
+    void dropClient(int player)
+    {
+        cout << "Player " << player << " left" << endl;
+        clients[player].active = false;
+        world.killSnake(player);
+    }
+
+    void tick()
+    {
+        uint64_t tickStart = nowMicros();
+        uint32_t nextTick = world.tick + 1;
+
+        for (size_t i = 0; i < clients.size(); i++) {
+            ClientSlot& c = clients[i];
+            if (!c.active) {
+                continue;
+            }
+            if (tickStart - c.lastHeardUs > (uint64_t)NET_CLIENT_TIMEOUT_MS * 1000) {
+                dropClient((int)i);
+                continue;
+            }
+            if (c.hasInput) {
+                world.setDirection((int)i, c.inputDir);
+                c.hasInput = false;
+                c.ackSeq = c.inputSeq;
+                c.echoUs = c.inputSentUs;
+            }
+            if (!world.snakes[i].alive && nextTick >= c.respawnAt) {
+                world.spawnSnake((int)i);
+            }
+        }
+
+        uint64_t stepStart = nowMicros();
+        world.advance();
+        reportStepUs += nowMicros() - stepStart;
+
+        for (uint16_t id : world.delta.deaths) {
+            clients[id].respawnAt = world.tick + NET_RESPAWN_TICKS;
+        }
+
+        PacketWriter packet;
+        packet.size = HEADER_SIZE;
+        bool deltaFits = writeDeltaBody(packet, world.delta, world.stateHash());
+        vector<PacketWriter> keyframes;
+
+        for (ClientSlot& c : clients) {
+            if (!c.active) {
+                continue;
+            }
+            if (c.wantsKeyframe || !deltaFits) {
+                if (keyframes.empty()) {
+                    keyframes = writeKeyframes(world);
+                }
+                for (const PacketWriter& k : keyframes) {
+                    sendTo(c, k.data, k.size);
+                }
+                c.wantsKeyframe = false;
+            }
+
+            // The delta still goes out after a keyframe: it carries the input ack.
+            PacketWriter header;
+            header.put8(PACKET_DELTA);
+            header.put32(world.tick);
+            header.put32(c.ackSeq);
+            header.put64(c.echoUs);
+            memcpy(packet.data, header.data, HEADER_SIZE);
+            sendTo(c, packet.data, deltaFits ? packet.size : HEADER_SIZE);
+        }
+        world.delta.clear();
+
+        uint64_t tickUs = nowMicros() - tickStart;
+        reportTicks++;
+        reportTickUs += tickUs;
+        reportMaxTickUs = max(reportMaxTickUs, tickUs);
+    }
+
+    void report()
+    {
+        uint64_t now = nowMicros();
+        double seconds = max(1e-6, (now - lastReportUs) / 1e6);
+        int active = 0;
+        for (const ClientSlot& c : clients) {
+            active += c.active;
+        }
+
+        cout << fixed << setprecision(1)
+             << "tick " << world.tick << ": " << active << " clients, " << world.aliveCount() << " alive, "
+             << reportTicks / seconds << " ticks/s, step " << (reportTicks ? (double)reportStepUs / reportTicks : 0) << " us, "
+             << "tick " << (reportTicks ? (double)reportTickUs / reportTicks : 0) << " us (max " << reportMaxTickUs << "), "
+             << "downlink " << (active ? reportBytes / seconds / active / 1024.0 : 0) << " KiB/s per client, "
+             << lateTicks << " late" << endl;
+
+        lastReportUs = now;
+        reportTicks = reportStepUs = reportTickUs = reportMaxTickUs = reportBytes = 0;
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    int port = NET_DEFAULT_PORT, hz = 60, width = 128, height = 96, food = 64, seconds = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        int value = atoi(argv[i + 1]);
+        if (arg == "--port") port = value;
+        else if (arg == "--hz") hz = value;
+        else if (arg == "--width") width = value;
+        else if (arg == "--height") height = value;
+        else if (arg == "--food") food = value;
+        else if (arg == "--seconds") seconds = value;
+        else {
+            cout << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+    if (hz <= 0 || width < 8 || height < 8 || width * height > 65536) {
+        cout << "Board must be at least 8x8 and at most 65536 cells, and hz positive" << endl;
+        return 1;
+    }
+
+    signal(SIGINT, stopServer);
+    SnakeServer server(width, height, food, hz);
+    if (!server.listen((uint16_t)port)) {
+        return 1;
+    }
+    cout << "Serving a " << width << "x" << height << " board at " << hz << " Hz on UDP port " << port << endl;
+    server.run(seconds);
+    return 0;
+}
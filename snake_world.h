@@ -0,0 +1,336 @@
+#pragma once
+
+// Headless multi-snake board. This owns everything moveSnake mutates in
+// the single-player game (bodies, food, scores), for any number of snakes,
+// with no SDL dependency so it can run inside the network server.
+//
+// Every cell of the board carries the id of whatever occupies it, so a
+// head is checked against walls and every other body with one lookup.
+// Each step also records what changed (new heads, retired tails, food,
+// deaths, spawns) so callers can forward just the difference.
+
+#include <bits/stdc++.h>
+
+enum Direction : uint8_t {
+    DIR_UP = 0,
+    DIR_RIGHT,
+    DIR_DOWN,
+    DIR_LEFT,
+};
+
+const uint16_t CELL_EMPTY = 0;
+const uint16_t CELL_WALL = 0xFFFF;
+const int WORLD_SPAWN_LENGTH = 3;
+
+inline bool isReverse(int a, int b)
+{
+    return (a ^ b) == 2;
+}
+
+struct WorldSnake {
+    bool alive = false;
+    uint8_t dir = DIR_RIGHT;
+    uint8_t nextDir = DIR_RIGHT;
+    int score = 0;
+    uint32_t diedAtTick = 0;
+    std::deque<int32_t> body; // front is the head
+};
+
+struct WorldSpawn {
+    uint16_t id;
+    int32_t head;
+    uint8_t dir;
+    uint16_t length;
+};
+
+struct WorldDelta {
+    std::vector<std::pair<uint16_t, int32_t>> heads;
+    std::vector<uint16_t> tails;
+    std::vector<uint16_t> deaths;
+    std::vector<WorldSpawn> spawns;
+    std::vector<int32_t> foodAdded;
+    std::vector<int32_t> foodRemoved;
+
+    void clear()
+    {
+        heads.clear();
+        tails.clear();
+        deaths.clear();
+        spawns.clear();
+        foodAdded.clear();
+        foodRemoved.clear();
+    }
+};
+
+// Cheap fingerprint of the visible state (live heads, lengths and food) so
+// a replica that only sees deltas can tell when it has drifted.
+template <class Snakes, class Food>
+uint32_t boardStateHash(const Snakes& snakes, const Food& food)
+{
+    uint32_t h = 2166136261u;
+    auto mix = [&h](uint32_t v) { h = (h ^ v) * 16777619u; };
+    for (size_t id = 0; id < snakes.size(); id++) {
+        if (snakes[id].alive) {
+            mix((uint32_t)id);
+            mix((uint32_t)snakes[id].body.front());
+            mix((uint32_t)snakes[id].body.size());
+        }
+    }
+    uint32_t foodSum = 0;
+    for (int32_t cell : food) {
+        foodSum += (uint32_t)cell;
+    }
+    mix((uint32_t)food.size());
+    mix(foodSum);
+    return h;
+}
+
+class SnakeWorld {
+public:
+    SnakeWorld(int width, int height, int foodCount, uint32_t seed = 1)
+        : width(width), height(height), foodTarget(foodCount), rng(seed)
+    {
+        owner.assign(width * height, CELL_EMPTY);
+        foodSlot.assign(width * height, -1);
+        claimTick.assign(width * height, 0);
+        claimOwner.assign(width * height, 0);
+
+        for (int x = 0; x < width; x++) {
+            owner[cellAt(x, 0)] = CELL_WALL;
+            owner[cellAt(x, height - 1)] = CELL_WALL;
+        }
+        for (int y = 0; y < height; y++) {
+            owner[cellAt(0, y)] = CELL_WALL;
+            owner[cellAt(width - 1, y)] = CELL_WALL;
+        }
+    }
+
+    int width, height;
+    uint32_t tick = 0;
+    std::vector<WorldSnake> snakes;
+    std::vector<int32_t> food;
+    WorldDelta delta;
+    bool recordDelta = true; // off for local play, where nobody reads the delta
+
+    int cellAt(int x, int y) const { return y * width + x; }
+    int cellX(int cell) const { return cell % width; }
+    int cellY(int cell) const { return cell / width; }
+
+    int step(int cell, int dir) const
+    {
+        static const int dx[] = {0, 1, 0, -1};
+        static const int dy[] = {-1, 0, 1, 0};
+        return cell + dy[dir] * width + dx[dir];
+    }
+
+    uint16_t cellOwner(int cell) const { return owner[cell]; }
+    bool hasFood(int cell) const { return foodSlot[cell] >= 0; }
+
+    // Snake ids are 0-based; the board stores id + 1 so 0 can mean empty.
+    int addSnake()
+    {
+        snakes.emplace_back();
+        return (int)snakes.size() - 1;
+    }
+
+    void setDirection(int id, int dir)
+    {
+        WorldSnake& s = snakes[id];
+        if (s.alive && !isReverse(dir, s.dir)) {
+            s.nextDir = (uint8_t)dir;
+        }
+    }
+
+    // Places a straight snake of WORLD_SPAWN_LENGTH cells on a random empty stretch.
+    bool spawnSnake(int id)
+    {
+        WorldSnake& s = snakes[id];
+        if (s.alive) {
+            return true;
+        }
+
+        for (int attempt = 0; attempt < 64; attempt++) {
+            int dir = rng() % 4;
+            int head = randomInteriorCell();
+            int back = (dir + 2) % 4;
+
+            bool clear = true;
+            int cell = head;
+            for (int i = 0; i < WORLD_SPAWN_LENGTH && clear; i++) {
+                clear = owner[cell] == CELL_EMPTY && !hasFood(cell);
+                cell = step(cell, back);
+            }
+            // Leave room in front so a new snake does not die on its first move.
+            int ahead = step(head, dir);
+            clear = clear && owner[ahead] == CELL_EMPTY && owner[step(ahead, dir)] != CELL_WALL;
+            if (!clear) {
+                continue;
+            }
+
+            s.body.clear();
+            cell = head;
+            for (int i = 0; i < WORLD_SPAWN_LENGTH; i++) {
+                s.body.push_back(cell);
+                owner[cell] = (uint16_t)(id + 1);
+                cell = step(cell, back);
+            }
+            s.alive = true;
+            s.dir = s.nextDir = (uint8_t)dir;
+            s.score = 0;
+            if (recordDelta) {
+                delta.spawns.push_back({(uint16_t)id, head, (uint8_t)dir, (uint16_t)WORLD_SPAWN_LENGTH});
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void killSnake(int id)
+    {
+        WorldSnake& s = snakes[id];
+        if (!s.alive) {
+            return;
+        }
+        for (int32_t cell : s.body) {
+            if (owner[cell] == id + 1) {
+                owner[cell] = CELL_EMPTY;
+            }
+        }
+        s.body.clear();
+        s.alive = false;
+        s.diedAtTick = tick;
+        if (recordDelta) {
+            delta.deaths.push_back((uint16_t)id);
+        }
+    }
+
+    // Advances every live snake by one cell. Moves are simultaneous: tails
+    // that are about to move away are released first, then every new head
+    // claims its cell. Two heads claiming the same cell both die.
+    void advance()
+    {
+        tick++;
+        moving.clear();
+
+        for (size_t id = 0; id < snakes.size(); id++) {
+            WorldSnake& s = snakes[id];
+            if (!s.alive) {
+                continue;
+            }
+            s.dir = s.nextDir;
+            int head = step(s.body.front(), s.dir);
+            bool grows = hasFood(head);
+            if (!grows) {
+                int tail = s.body.back();
+                owner[tail] = CELL_EMPTY;
+                s.body.pop_back();
+            }
+            moving.push_back({(uint16_t)id, head, grows});
+        }
+
+        for (Move& m : moving) {
+            if (owner[m.head] != CELL_EMPTY) {
+                m.dead = true;
+            }
+            if (claimTick[m.head] == tick) {
+                m.dead = true;
+                moving[claimOwner[m.head]].dead = true;
+            } else {
+                claimTick[m.head] = tick;
+                claimOwner[m.head] = (uint32_t)(&m - moving.data());
+            }
+        }
+
+        for (Move& m : moving) {
+            WorldSnake& s = snakes[m.id];
+            if (m.dead) {
+                killSnake(m.id);
+                continue;
+            }
+            s.body.push_front(m.head);
+            owner[m.head] = (uint16_t)(m.id + 1);
+            if (recordDelta) {
+                delta.heads.push_back({m.id, m.head});
+            }
+            if (m.grows) {
+                s.score += 10;
+                removeFood(m.head);
+            } else {
+                if (recordDelta) {
+                    delta.tails.push_back(m.id);
+                }
+            }
+        }
+
+        refillFood();
+    }
+
+    void refillFood()
+    {
+        for (int attempt = 0; (int)food.size() < foodTarget && attempt < foodTarget * 8; attempt++) {
+            int cell = randomInteriorCell();
+            if (owner[cell] == CELL_EMPTY && !hasFood(cell)) {
+                addFood(cell);
+            }
+        }
+    }
+
+    void addFood(int cell)
+    {
+        foodSlot[cell] = (int32_t)food.size();
+        food.push_back(cell);
+        if (recordDelta) {
+            delta.foodAdded.push_back(cell);
+        }
+    }
+
+    void removeFood(int cell)
+    {
+        int slot = foodSlot[cell];
+        food[slot] = food.back();
+        foodSlot[food[slot]] = slot;
+        food.pop_back();
+        foodSlot[cell] = -1;
+        if (recordDelta) {
+            delta.foodRemoved.push_back(cell);
+        }
+    }
+
+    int aliveCount() const
+    {
+        int n = 0;
+        for (const WorldSnake& s : snakes) {
+            n += s.alive;
+        }
+        return n;
+    }
+
+    uint32_t stateHash() const
+    {
+        return boardStateHash(snakes, food);
+    }
+
+private:
+    struct Move {
+        uint16_t id;
+        int32_t head;
+        bool grows;
+        bool dead = false;
+        Move(uint16_t id, int32_t head, bool grows) : id(id), head(head), grows(grows) {}
+    };
+
+    int foodTarget;
+    std::mt19937 rng;
+    std::vector<uint16_t> owner;
+    std::vector<int32_t> foodSlot;
+    std::vector<uint32_t> claimTick;
+    std::vector<uint32_t> claimOwner;
+    std::vector<Move> moving;
+
+    int randomInteriorCell()
+    {
+        int x = 1 + rng() % (width - 2);
+        int y = 1 + rng() % (height - 2);
+        return cellAt(x, y);
+    }
+};
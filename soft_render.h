@@ -0,0 +1,156 @@
+#pragma once
+
+// Software framebuffer for rendering without a display. Pixels are RGBA
+// bytes in memory order (the same layout as SDL_PIXELFORMAT_RGBA32).
+// Sprites are stored premultiplied with a per-byte inverse-alpha plane, so
+// a blit row is one flat byte loop that the compiler vectorizes.
+
+#include <bits/stdc++.h>
+
+struct SoftSprite {
+    int width = 0, height = 0;
+    std::vector<uint8_t> rgba;     // premultiplied
+    std::vector<uint8_t> inverse;  // 255 - alpha, repeated for every byte
+};
+
+// Builds a sprite from straight-alpha RGBA pixels, nearest-sampled to
+// width x height.
+inline SoftSprite makeSprite(const uint8_t* pixels, int srcWidth, int srcHeight, int srcPitch, int width, int height)
+{
+    SoftSprite s;
+    s.width = width;
+    s.height = height;
+    s.rgba.resize(width * height * 4);
+    s.inverse.resize(width * height * 4);
+    for (int y = 0; y < height; y++) {
+        const uint8_t* row = pixels + (y * srcHeight / height) * srcPitch;
+        for (int x = 0; x < width; x++) {
+            const uint8_t* p = row + (x * srcWidth / width) * 4;
+            uint8_t* d = &s.rgba[(y * width + x) * 4];
+            int a = p[3];
+            d[0] = (uint8_t)((p[0] * a + 127) / 255);
+            d[1] = (uint8_t)((p[1] * a + 127) / 255);
+            d[2] = (uint8_t)((p[2] * a + 127) / 255);
+            d[3] = (uint8_t)a;
+            std::fill_n(&s.inverse[(y * width + x) * 4], 4, (uint8_t)(255 - a));
+        }
+    }
+    return s;
+}
+
+// A filled disc, used for body segments and as a stand-in for missing images.
+inline SoftSprite makeDisc(int size, uint8_t r, uint8_t g, uint8_t b)
+{
+    std::vector<uint8_t> pixels(size * size * 4, 0);
+    float radius = size / 2.0f;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            float cx = x + 0.5f - radius, cy = y + 0.5f - radius;
+            if (cx * cx + cy * cy <= radius * radius) {
+                uint8_t* p = &pixels[(y * size + x) * 4];
+                p[0] = r;
+                p[1] = g;
+                p[2] = b;
+                p[3] = 255;
+            }
+        }
+    }
+    return makeSprite(pixels.data(), size, size, size * 4, size, size);
+}
+
+// 5x7 glyphs for the score line; one byte per row, low 5 bits used.
+inline const uint8_t* glyphRows(char c)
+{
+    static const uint8_t digits[10][7] = {
+        {14, 17, 19, 21, 25, 17, 14}, {4, 12, 4, 4, 4, 4, 14},    {14, 17, 1, 2, 4, 8, 31},
+        {31, 2, 4, 2, 1, 17, 14},     {2, 6, 10, 18, 31, 2, 2},   {31, 16, 30, 1, 1, 17, 14},
+        {6, 8, 16, 30, 17, 17, 14},   {31, 1, 2, 4, 8, 8, 8},     {14, 17, 17, 14, 17, 17, 14},
+        {14, 17, 17, 15, 1, 2, 12},
+    };
+    static const uint8_t S[7] = {15, 16, 16, 14, 1, 1, 30};
+    static const uint8_t c_[7] = {0, 0, 14, 16, 16, 17, 14};
+    static const uint8_t o[7] = {0, 0, 14, 17, 17, 17, 14};
+    static const uint8_t r[7] = {0, 0, 22, 25, 16, 16, 16};
+    static const uint8_t e[7] = {0, 0, 14, 17, 31, 16, 14};
+    static const uint8_t colon[7] = {0, 12, 12, 0, 12, 12, 0};
+    static const uint8_t minus[7] = {0, 0, 0, 31, 0, 0, 0};
+    static const uint8_t blank[7] = {0, 0, 0, 0, 0, 0, 0};
+
+    if (c >= '0' && c <= '9') return digits[c - '0'];
+    switch (c) {
+        case 'S': return S;
+        case 'c': return c_;
+        case 'o': return o;
+        case 'r': return r;
+        case 'e': return e;
+        case ':': return colon;
+        case '-': return minus;
+        default: return blank;
+    }
+}
+
+class Framebuffer {
+public:
+    int width, height;
+    std::vector<uint8_t> rgba;
+
+    Framebuffer(int width, int height) : width(width), height(height), rgba(width * height * 4) {}
+
+    void clear(uint8_t r, uint8_t g, uint8_t b)
+    {
+        fillRect(0, 0, width, height, r, g, b);
+    }
+
+    void fillRect(int x, int y, int w, int h, uint8_t r, uint8_t g, uint8_t b)
+    {
+        int x0 = std::max(x, 0), y0 = std::max(y, 0);
+        int x1 = std::min(x + w, width), y1 = std::min(y + h, height);
+        if (x0 >= x1 || y0 >= y1) {
+            return;
+        }
+        uint32_t color;
+        uint8_t bytes[4] = {r, g, b, 255};
+        memcpy(&color, bytes, 4);
+
+        for (int row = y0; row < y1; row++) {
+            uint32_t* p = reinterpret_cast<uint32_t*>(&rgba[(row * width + x0) * 4]);
+            std::fill_n(p, x1 - x0, color);
+        }
+    }
+
+    // Premultiplied "over": dst = src + dst * (255 - srcAlpha) / 255.
+    void blit(const SoftSprite& s, int x, int y)
+    {
+        int x0 = std::max(x, 0), y0 = std::max(y, 0);
+        int x1 = std::min(x + s.width, width), y1 = std::min(y + s.height, height);
+        if (x0 >= x1 || y0 >= y1) {
+            return;
+        }
+        int bytes = (x1 - x0) * 4;
+        for (int row = y0; row < y1; row++) {
+            uint8_t* __restrict d = &rgba[(row * width + x0) * 4];
+            size_t offset = ((row - y) * s.width + (x0 - x)) * 4;
+            const uint8_t* __restrict src = &s.rgba[offset];
+            const uint8_t* __restrict inv = &s.inverse[offset];
+            for (int i = 0; i < bytes; i++) {
+                unsigned v = d[i] * inv[i] + 128;
+                d[i] = (uint8_t)(src[i] + ((v + (v >> 8)) >> 8));
+            }
+        }
+    }
+
+    void drawText(const std::string& text, int x, int y, int scale, uint8_t r, uint8_t g, uint8_t b)
+    {
+        for (char c : text) {
+            const uint8_t* rows = glyphRows(c);
+            for (int gy = 0; gy < 7; gy++) {
+                for (int gx = 0; gx < 5; gx++) {
+                    if (rows[gy] & (16 >> gx)) {
+                        fillRect(x + gx * scale, y + gy * scale, scale, scale, r, g, b);
+                    }
+                }
+            }
+            x += 6 * scale;
+        }
+    }
+};
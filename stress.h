@@ -0,0 +1,171 @@
+#pragma once
+
+// Synthetic worst cases for the game core and the renderer, so tail
+// latency can be measured the same way on every run instead of waiting for
+// a real game to get there:
+//   full   the snake starts on 95% of the board and circles a Hamiltonian
+//          cycle, so every frame draws a near-maximal body and every food
+//          spawn searches a nearly full board (classic rules)
+//   churn  a greedy player that heads straight for food and bonuses, so
+//          spawns, bonus timers and deaths come as fast as the rules allow
+//          (classic rules)
+//   maze   the same player under task301's rules, continuing every pause
+// A game that ends, or grows past 97% of the board, is restarted with the
+// next seed, so a driver is deterministic for a given seed.
+
+#include "snake_core.h"
+
+enum StressScenario {
+    STRESS_FULL = 0,
+    STRESS_CHURN,
+    STRESS_MAZE,
+    STRESS_COUNT,
+};
+
+const char* const STRESS_NAMES[STRESS_COUNT] = {"full", "churn", "maze"};
+const double STRESS_START_FILL = 0.95;
+const double STRESS_RESTART_FILL = 0.97;
+
+// -1 if the name is unknown.
+inline int stressScenario(const std::string& name)
+{
+    for (int i = 0; i < STRESS_COUNT; i++) {
+        if (name == STRESS_NAMES[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Whether a game with these rules can run the scenario.
+inline bool stressFits(StressScenario scenario, const CoreRules& rules)
+{
+    return (scenario == STRESS_MAZE) == rules.maze;
+}
+
+// Every cell inside the border walls as one closed path, in pixels: along
+// the top row, back and forth over the rows below it (leaving out the
+// first column) and up the first column. Needs an even number of rows.
+inline std::vector<Segment> hamiltonianCycle(const CoreRules& rules)
+{
+    int c = rules.cellSize;
+    int cols = rules.screenWidth / c - 2, rows = rules.screenHeight / c - 2;
+    if (rows % 2 != 0 || cols < 2) {
+        std::cout << "Error: No Hamiltonian cycle for a " << cols << "x" << rows << " board" << std::endl;
+        exit(1);
+    }
+    std::vector<Segment> cycle;
+    for (int x = 1; x <= cols; x++) {
+        cycle.push_back({x * c, c});
+    }
+    for (int y = 2; y <= rows; y++) {
+        for (int i = 0; i < cols - 1; i++) {
+            int x = y % 2 == 0 ? cols - i : 2 + i;
+            cycle.push_back({x * c, y * c});
+        }
+    }
+    for (int y = rows; y >= 2; y--) {
+        cycle.push_back({c, y * c});
+    }
+    return cycle;
+}
+
+class StressDriver {
+public:
+    StressDriver(const CoreRules& rules, StressScenario scenario, uint64_t seed)
+        : rules(rules), scenario(scenario), arena(SnakeCore::bytesFor(rules) + 256), seed(seed)
+    {
+        if (scenario == STRESS_FULL) {
+            cycle = hamiltonianCycle(rules);
+        }
+        restart();
+    }
+
+    SnakeCore& core()
+    {
+        return *game;
+    }
+
+    int restarts() const
+    {
+        return games - 1;
+    }
+
+    // Starts the next game if this one is over or too full; true if it
+    // did, so the caller can leave the restart out of its timings.
+    bool restartIfDone()
+    {
+        if (!game->over() && game->body().size() < restartLength) {
+            return false;
+        }
+        restart();
+        return true;
+    }
+
+    // The input for the next tick; dx and dy in pixels.
+    void nextInput(int& dx, int& dy, int& continues)
+    {
+        const Segment& head = game->body()[0];
+        continues = 0;
+        if (scenario == STRESS_FULL) {
+            position = (position + 1) % cycle.size();
+            dx = cycle[position].x - head.x;
+            dy = cycle[position].y - head.y;
+            return;
+        }
+        if (game->isPaused()) {
+            continues = 1;
+            dx = lastDx;
+            dy = lastDy;
+            return;
+        }
+
+        // Toward the bonus or the food, away from the border and its own
+        // body; the maze's inner walls only pause, so it goes through them.
+        Segment target = game->bonusActive() ? game->bonus() : game->food();
+        const int steps[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+        int c = rules.cellSize, best = INT_MAX;
+        for (const auto& step : steps) {
+            Segment next = {head.x + step[0] * c, head.y + step[1] * c};
+            bool blocked = next.x < c || next.x >= rules.screenWidth - c || next.y < c || next.y >= rules.screenHeight - c ||
+                           game->body().occupies(next);
+            int cost = abs(next.x - target.x) + abs(next.y - target.y) + (blocked ? 100000 : 0) + (int)(random.next() % c);
+            if (cost < best) {
+                best = cost;
+                dx = step[0] * c;
+                dy = step[1] * c;
+            }
+        }
+        lastDx = dx;
+        lastDy = dy;
+    }
+
+private:
+    CoreRules rules;
+    StressScenario scenario;
+    Arena arena;
+    uint64_t seed;
+    std::optional<SnakeCore> game;
+    std::vector<Segment> cycle; // full only
+    size_t position = 0;        // index of the head in cycle
+    size_t restartLength = SIZE_MAX;
+    CoreRandom random = {0};
+    int games = 0;
+    int lastDx = 0, lastDy = 0;
+
+    void restart()
+    {
+        game.reset();
+        arena.reset();
+        game.emplace(arena, rules, seed + games);
+        random.state = seed + games;
+        games++;
+        if (scenario == STRESS_FULL) {
+            size_t length = (size_t)(cycle.size() * STRESS_START_FILL);
+            std::vector<Segment> body(cycle.rend() - length, cycle.rend());
+            game->placeBody(body.data(), (int)length);
+            position = length - 1;
+            restartLength = (size_t)(cycle.size() * STRESS_RESTART_FILL);
+        }
+    }
+};
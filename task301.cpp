@@ -4,6 +4,23 @@
     #include <SDL2/SDL_mixer.h>
     #include <fstream> 
     #include <bits/stdc++.h>
+    #include "score_sync.h" // Winsock has to come before leaderboard.h's windows.h
+    #include "leaderboard.h"
+    #include "telemetry.h"
+    #include "render_queue.h"
+    #include "ui.h"
+    #include "logical_screen.h"
+    #include "triple_buffer.h"
+    #include "timing_stats.h"
+    #include "replay.h"
+    #include "snake_core.h"
+    #include "stress.h"
+    #include "latency_probe.h"
+    #include "savegame.h"
+    #include "hamiltonian.h"
+    #include "rewind.h"
+    #include "alloc_tracker.h"
+    #include "audio.h"
 
     using namespace std;
 
@@ -12,97 +29,359 @@
     const int SQUARE_SIZE = 20;
     const int SNAKE_SPEED = 120;
     const int BONUS_FOOD_SIZE = SQUARE_SIZE * 2;
+    const int BOARD_COLS = SCREEN_WIDTH / SQUARE_SIZE;
+    const int BOARD_ROWS = SCREEN_HEIGHT / SQUARE_SIZE;
+    const int BOARD_CELLS = BOARD_COLS * BOARD_ROWS;
+
+    const auto processStart = chrono::steady_clock::now();
+
+    // Everything suruKor creates; released by cleanupSDL.
+    struct SdlResources {
+        WindowHandle window;
+        RendererHandle renderer;
+        FontHandle font;
+        TextureHandle spriteAtlas;
+        SurfaceHandle offscreen; // --bench-replays draws here instead of a window
+    };
 
-    Mix_Chunk* gameOverSound = nullptr;
-    Mix_Chunk* eatingSound = nullptr;
-    Mix_Chunk* bonusSound = nullptr;
-
-    SDL_Texture* appleTexture = nullptr;
-    SDL_Texture* snakeHeadTexture = nullptr;
+    SdlResources sdl;
+    AtlasGlyphs atlasGlyphs;
+    RenderQueue renderQueue;
 
-    bool bonusFoodActive = false;
-    Uint32 bonusFoodStartTime = 0;
     const int BONUS_FOOD_DURATION = 4000;
-    int foodCounter = 0; 
-    SDL_Texture* bonusFoodTexture = nullptr;
-    int score=0;
-
-    bool paused=false;
+    const int BONUS_FOOD_TICKS = BONUS_FOOD_DURATION / SNAKE_SPEED;
+    const CoreRules RULES = {SCREEN_WIDTH, SCREEN_HEIGHT, SQUARE_SIZE, 2, BONUS_FOOD_TICKS, true};
+
+    atomic<int> continueRequests{0};
+    atomic<int> rewindRequests{0};
+
+    // r takes the game back REWIND_SECONDS, as often as the last
+    // REWIND_KEPT_SECONDS allow, so a death or a maze pause can be undone.
+    const int REWIND_SECONDS = 2;
+    const int REWIND_KEPT_SECONDS = 10;
+    const int REWIND_TICKS = REWIND_SECONDS * 1000 / SNAKE_SPEED;
+    const int REWIND_CAPACITY = REWIND_KEPT_SECONDS * 1000 / SNAKE_SPEED;
+    bool rewindEnabled = true; // --no-rewind
+
+    // Everything renderGame needs, copied out by the simulation thread once
+    // per tick. Each slot's body buffer and entity columns are carved from
+    // the game arena.
+    struct GameSnapshot {
+        uint32_t* snake; // cells, head first
+        int length;
+        EntityColumns entities;
+        int score;
+        uint64_t tickP99Ns; // for the F3 latency line
+        uint32_t inputSeq;  // latest key press the simulation has read
+        chrono::steady_clock::time_point inputAppliedAt;
+        bool paused;
+        bool over;
+    };
 
-    struct Segment {
-        int x, y;
+    // The simulation runs on its own thread at a fixed SNAKE_SPEED tick; the
+    // main thread only handles input and draws the latest published snapshot.
+    struct Simulation {
+        TripleBuffer<GameSnapshot> frames;
+        atomic<uint32_t> input{0}; // packed direction, latency probe sequence number above it
+        uint32_t inputSeq = 0;
+        chrono::steady_clock::time_point inputAppliedAt;
+        atomic<bool> stop{false};
+        atomic<bool> finished{false};
+        TimingStats tickJitter;
+        TimingStats tickWork;
+        uint64_t tickP99Ns = 0;
+        ReplayRecorder replay;
+        atomic<int> steeredDirection{-1}; // packed; the autopilot's last move, for the main thread to pick up
+        RewindBuffer rewind;
+        atomic<int> rewoundDirection{-1}; // packed; for the main thread to pick up after a rewind
+        bool rewound = false;
     };
 
+    int renderLoadMs = 0;
+    bool fullscreen = false; // --fullscreen
+    atomic<bool> showLatency{false}; // toggled with F3
+    uint64_t frameP99Ns = 0;
+    optional<InputInjector> injector; // --inject-inputs: no menus, no player
+    HamiltonianCycle boardCycle;      // the autopilot's path; empty if the board has none
+    CycleAutopilot autopilot(boardCycle);
+    atomic<bool> autopilotOn{false}; // toggled with F2, or --autopilot
+
    
-    void suruKor(SDL_Window*& window, SDL_Renderer*& renderer, TTF_Font*& font, SDL_Texture*& appleTexture);
-    void cobiDekha(SDL_Renderer* renderer, const char* imagePath, int displayTimeMs);
-    void cleanupSDL(SDL_Window* window, SDL_Renderer* renderer, TTF_Font* font,SDL_Texture* appleTexturet);
-    void firstCobiDekha(SDL_Renderer* renderer, TTF_Font* font);
-    void sesCobiDekha(SDL_Renderer* renderer,TTF_Font* font,int score,int high_score);
-    Segment khabarToiriKor();
-    Segment bonusFood;
+    void suruKor();
+    void initLibraries();
+    void loadAssets();
+    void startOffscreen();
+    int benchReplays(const string& dir);
+    int runStress(const string& name, int ticks);
+    void timedTick(Simulation& sim, SnakeCore& core, int dx, int dy, int continues, TimingStats& tickTime, TimingStats& frameTime);
+    void stepCore(Simulation& sim, SnakeCore& core, int dx, int dy, int continues);
+    void allocateSnapshots(Simulation& sim, Arena& arena);
+    void cleanupSDL();
+    bool firstCobiDekha(SDL_Renderer* renderer, TTF_Font* font);
+    void firstFrameShown();
+    bool playGame(SDL_Renderer* renderer, TTF_Font* font, SDL_Texture* spriteAtlas);
+    bool sesCobiDekha(SDL_Renderer* renderer,TTF_Font* font,int score,int high_score,int length);
     void handleEvents(bool& quit, int& dx, int& dy);
-    bool checkCollision(const Segment& a, const Segment& b);
-    bool checkBonusCollision(const Segment& a, const Segment& b);
-    void moveSnake(vector<Segment>& snake, int dx, int dy, Segment& food, bool& foodEaten, bool& quit, int& score);
-    void renderGame(SDL_Renderer* renderer, const vector<Segment>& snake, const Segment& food, TTF_Font* font, int score,SDL_Texture* appleTexture);
-    void renderText(SDL_Renderer* renderer, TTF_Font* font, const string& text, int x, int y);
-    void saveHighScore(int highScore);
+    void renderGame(SDL_Renderer* renderer, const GameSnapshot& frame, TTF_Font* font, SDL_Texture* spriteAtlas);
+    void runSimulation(Simulation& sim, SnakeCore& core);
+    void reportEvents(const SnakeCore& core);
+    void publishSnapshot(Simulation& sim, const SnakeCore& core, uint8_t input);
+    Arena& gameArena();
+    int packDirection(int dx, int dy);
+    int autopilotDirection(const SnakeCore& core);
+    void toggleAutopilot();
+    void saveHighScore(int score, int length);
     int loadHighScore();
 
     int main(int argc, char* argv[]) 
     {
-        SDL_Window* window = nullptr;
-        SDL_Renderer* renderer = nullptr;
-        TTF_Font* font = nullptr;
+        // --render-load-ms N stalls every frame by N ms, to check the
+        // simulation tick keeps its pace when rendering is slow.
+        // --no-audio skips the audio device entirely.
+        // --fullscreen fills the display, the 640x480 scene scaled up by
+        // whole pixels; the window can also be resized.
+        // --bench-replays DIR replays recorded games without a window and
+        // exits; see benchReplays.
+        // --stress NAME [--stress-ticks N] runs a stress.h scenario the
+        // same way; see runStress.
+        // --inject-inputs N [--inject-seed S] plays unattended, with N
+        // synthetic key presses, for the input latency probe.
+        // --sync-url URL [--kiosk-id NAME] also posts every finished game
+        // to a central leaderboard; see score_sync.h.
+        // --autopilot starts every game with the autopilot steering (F2
+        // toggles it; an arrow key takes over); see hamiltonian.h.
+        // --no-rewind stops keeping ticks for r, to compare its cost.
+        string stressName;
+        int stressTicks = 100000;
+        int injectInputs = 0;
+        uint64_t injectSeed = 1;
+        string syncUrl, kioskId;
+        for (int i = 1; i < argc; i++) {
+            string arg = argv[i];
+            if (arg == "--render-load-ms" && i + 1 < argc) {
+                renderLoadMs = atoi(argv[++i]);
+            } else if (arg == "--no-audio") {
+                audio().startSilent();
+            } else if (arg == "--fullscreen") {
+                fullscreen = true;
+            } else if (arg == "--bench-replays" && i + 1 < argc) {
+                return benchReplays(argv[++i]);
+            } else if (arg == "--stress" && i + 1 < argc) {
+                stressName = argv[++i];
+            } else if (arg == "--stress-ticks" && i + 1 < argc) {
+                stressTicks = max(1, atoi(argv[++i]));
+            } else if (arg == "--inject-inputs" && i + 1 < argc) {
+                injectInputs = max(1, atoi(argv[++i]));
+            } else if (arg == "--inject-seed" && i + 1 < argc) {
+                injectSeed = strtoull(argv[++i], nullptr, 10);
+            } else if (arg == "--sync-url" && i + 1 < argc) {
+                syncUrl = argv[++i];
+            } else if (arg == "--kiosk-id" && i + 1 < argc) {
+                kioskId = argv[++i];
+            } else if (arg == "--autopilot") {
+                autopilotOn = true;
+            } else if (arg == "--no-rewind") {
+                rewindEnabled = false;
+            }
+        }
+        if (!stressName.empty()) {
+            return runStress(stressName, stressTicks);
+        }
 
-        suruKor(window, renderer, font,appleTexture);
-        firstCobiDekha(renderer,font);
+        boardCycle = cachedCycle(RULES, max(1u, thread::hardware_concurrency()));
+        if (autopilotOn && boardCycle.empty()) {
+            cout << "No Hamiltonian cycle on this board, so no autopilot" << endl;
+            autopilotOn = false;
+        }
 
+        trackSdlAllocations();
+        suruKor();
+        if (!syncUrl.empty()) {
+            scoreSync().start(syncUrl, kioskId);
+        }
+        if (injectInputs > 0) {
+            injector.emplace(injectInputs, injectSeed);
+        }
+        // Restarting loops back to the cover screen on the same window and
+        // renderer, so a long session does not pile up SDL objects.
+        while (firstCobiDekha(sdl.renderer.get(), sdl.font.get()) &&
+               playGame(sdl.renderer.get(), sdl.font.get(), sdl.spriteAtlas.get())) {
+            resources().report(cout, "after game");
+        }
+
+        cleanupSDL();
+        return 0;
+    }
+
+    // One game, from the first tick to the game over screen; true if the
+    // player chose to restart.
+    bool playGame(SDL_Renderer* renderer, TTF_Font* font, SDL_Texture* spriteAtlas)
+    {
         bool quit = false;
-        vector<Segment> snake = {{SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2}};
+        Arena& arena = gameArena();
+        arena.reset();
+        // Seeded from rand(), so each game in a session is different.
+        uint64_t seed = rand();
+        SnakeCore core(arena, RULES, seed);
         int dx = SQUARE_SIZE;
         int dy = 0;
 
-        Segment food = khabarToiriKor();
-        Uint32 lastMove = SDL_GetTicks();
-         score = 0;
+        // Pick up where the last session quit mid-game, if it did.
+        CoreState saved;
+        Segment* savedBody;
+        int savedLength, savedDirection;
+        bool resumed = readSave(saveFileFor(LAYOUT_MAZE), LAYOUT_MAZE, RULES, arena, saved, savedBody, savedLength, savedDirection);
+        if (resumed) {
+            core.restore(saved, savedBody, savedLength);
+            dx = (savedDirection / 3 - 1) * SQUARE_SIZE;
+            dy = (savedDirection % 3 - 1) * SQUARE_SIZE;
+            remove(saveFileFor(LAYOUT_MAZE));
+            cout << "Resumed saved game: score " << core.score() << ", length " << core.body().size() << endl;
+        }
+
+        auto gameStart = chrono::steady_clock::now();
+        telemetry().beginGame();
+        telemetry().log(EVENT_GAME_START, core.body()[0].x, core.body()[0].y, 0, core.body().size());
 
          int highScore = loadHighScore();
        
 
+        Simulation sim;
+        allocateSnapshots(sim, arena);
+        sim.input = packDirection(dx, dy);
+        sim.replay.begin(LAYOUT_MAZE, SCREEN_WIDTH, SCREEN_HEIGHT, SQUARE_SIZE, SNAKE_SPEED, seed,
+                         arena.allocate<ReplayFrame>(REPLAY_MAX_FRAMES), REPLAY_MAX_FRAMES);
+        publishSnapshot(sim, core, 0);
+        thread simThread(runSimulation, ref(sim), ref(core));
+
+        TimingStats frameTime;
+        LatencyProbe probe;
+        uint32_t inputSeq = 0;
+        uint32_t checkedFrames = 0;
         while (!quit) {
+            int rewoundTo = sim.rewoundDirection.exchange(-1);
+            if (rewoundTo >= 0) {
+                dx = (rewoundTo / 3 - 1) * SQUARE_SIZE;
+                dy = (rewoundTo % 3 - 1) * SQUARE_SIZE;
+            }
+            int steeredTo = sim.steeredDirection.exchange(-1);
+            if (steeredTo >= 0) {
+                dx = (steeredTo / 3 - 1) * SQUARE_SIZE;
+                dy = (steeredTo % 3 - 1) * SQUARE_SIZE;
+            }
+            int oldDx = dx, oldDy = dy;
             handleEvents(quit, dx, dy);
+            if (dx != oldDx || dy != oldDy) {
+                inputSeq = probe.inputChanged(chrono::steady_clock::now());
+            }
+            sim.input = inputSeq << 4 | packDirection(dx, dy);
 
-            if (SDL_GetTicks() - lastMove > SNAKE_SPEED) {
-                lastMove = SDL_GetTicks();
-
-                bool foodEaten = false;
-                moveSnake(snake, dx, dy, food, foodEaten, quit, score);
-
-                if (foodEaten) {
-                    food = khabarToiriKor();
+            bool finished = sim.finished;
+            if (sim.frames.update()) {
+                auto start = chrono::steady_clock::now();
+                {
+                    SteadyStateCheck check("frame", checkedFrames);
+                    renderGame(renderer, sim.frames.front(), font, spriteAtlas);
                 }
-
-                renderGame(renderer, snake, food, font, score,appleTexture);
+                probe.presented(sim.frames.front().inputSeq, sim.frames.front().inputAppliedAt, chrono::steady_clock::now());
+                if (renderLoadMs > 0) {
+                    SDL_Delay(renderLoadMs);
+                }
+                frameTime.record(elapsedNanos(start, chrono::steady_clock::now()));
+                if (showLatency && frameTime.count() % 30 == 0) {
+                    frameP99Ns = frameTime.percentileNs(0.99);
+                }
+            } else if (finished) {
+                quit = true;
+            } else {
+                SDL_Delay(1);
             }
 
-            if (quit) {
-
-                 if (score > highScore) {
-                highScore = score;
-                saveHighScore(highScore);  
+            if (injector) {
+                const GameSnapshot& shown = sim.frames.front();
+                injector->poll(shown.snake, shown.length, dx, dy, SQUARE_SIZE, SCREEN_WIDTH, SCREEN_HEIGHT, shown.paused);
+                quit = quit || injector->done();
             }
-            sesCobiDekha(renderer,font,score,highScore);
+        }
+
+        sim.stop = true;
+        simThread.join();
+        uint32_t durationMs = (uint32_t)(elapsedNanos(gameStart, chrono::steady_clock::now()) / 1000000);
+        uint32_t replayHash = 0;
+        // A resumed or rewound game's replay cannot be re-simulated from its
+        // seed.
+        if (!resumed && !sim.rewound) {
+            replayHash = sim.replay.save().empty() ? 0 : sim.replay.hash();
+        }
+        bool savedForLater = false;
+        if (!core.over() && !injector) {
+            auto start = chrono::steady_clock::now();
+            if (writeSave(saveFileFor(LAYOUT_MAZE), LAYOUT_MAZE, RULES, core, packDirection(dx, dy))) {
+                savedForLater = true;
+                cout << "Saved game in " << elapsedNanos(start, chrono::steady_clock::now()) / 1000 << " us" << endl;
             }
         }
+        sim.tickJitter.print(cout, "sim tick jitter");
+        sim.tickWork.print(cout, "sim tick work");
+        frameTime.print(cout, "render frame");
+        probe.print(cout);
+        if (rewindEnabled) {
+            sim.rewind.print(cout);
+        }
 
-        cleanupSDL(window, renderer, font,appleTexture);
-        return 0;
+        saveHighScore(core.score(), core.body().size());
+        // A game saved to resume later has not finished yet.
+        if (!savedForLater) {
+            scoreSync().submit(core.score(), core.body().size(), durationMs, replayHash, LAYOUT_MAZE);
+        }
+        highScore = loadHighScore();
+        return sesCobiDekha(renderer,font,core.score(),highScore,core.body().size());
     }
 
 
-    void suruKor(SDL_Window*& window, SDL_Renderer*& renderer, TTF_Font*& font, SDL_Texture*& appleTexture)
+    void suruKor()
+    {
+        // Touch the singletons cleanupSDL uses before registering it, so
+        // they are still alive when it runs at exit.
+        audio();
+        uiCache();
+        logicalScreen();
+        leaderboard();
+        scoreSync();
+        atexit(cleanupSDL);
+        initLibraries();
+
+        sdl.window = WindowHandle(SDL_CreateWindow("Simple Snake Game",
+                                SDL_WINDOWPOS_CENTERED,
+                                SDL_WINDOWPOS_CENTERED,
+                                SCREEN_WIDTH,
+                                SCREEN_HEIGHT,
+                                SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE | (fullscreen ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0)));
+
+        if (!sdl.window)
+         {
+            cout << "Window could not be created! SDL_Error: " << SDL_GetError() << endl;
+            exit(1);
+         }
+
+        sdl.renderer = RendererHandle(SDL_CreateRenderer(sdl.window.get(), -1, SDL_RENDERER_ACCELERATED));
+        if (!sdl.renderer) 
+        {
+            // No GPU, e.g. the dummy video driver an unattended run uses.
+            sdl.renderer = RendererHandle(SDL_CreateRenderer(sdl.window.get(), -1, SDL_RENDERER_SOFTWARE));
+        }
+        if (!sdl.renderer) 
+        {
+            cout << "Renderer could not be created! SDL_Error: " << SDL_GetError() << endl;
+            exit(1);
+        }
+        logicalScreen().attach(sdl.renderer.get(), SCREEN_WIDTH, SCREEN_HEIGHT);
+
+        loadAssets();
+        resources().report(cout, "at startup");
+    }
+
+    void initLibraries()
     {
         if (SDL_Init(SDL_INIT_VIDEO) < 0) {
             cout << "SDL could not initialize! SDL_Error: " << SDL_GetError() << endl;
@@ -120,268 +399,252 @@
             cout << "SDL_ttf could not initialize! SDL_ttf Error: " << TTF_GetError() << endl;
             exit(1);
         }
+    }
 
-        if (Mix_Init(MIX_INIT_MP3) == 0) 
+    // Font, sprite atlas and render queue for sdl.renderer.
+    void loadAssets()
+    {
+        sdl.font = ownFont(TTF_OpenFont("fonts/atop-font.ttf", 24), "fonts/atop-font.ttf");
+        if (!sdl.font) 
         {
-        cout << "SDL_mixer could not initialize! SDL_mixer Error: " << Mix_GetError() << endl;
-        exit(1);
+            cout << "Failed to load font! SDL_ttf Error: " << TTF_GetError() << endl;
+            exit(1);
         }
 
-       if (Mix_OpenAudio(22050, MIX_DEFAULT_FORMAT, 2, 4096) == -1)
-       {
-        cout << "SDL_mixer could not open audio! SDL_mixer Error: " << Mix_GetError() << endl;
+        
+    sdl.spriteAtlas = ownTexture(buildSpriteAtlas(sdl.renderer.get(), sdl.font.get(), atlasGlyphs));
+    if (!sdl.spriteAtlas) 
+    {
         exit(1);
-       }
-
-    gameOverSound = Mix_LoadWAV("sound/gameover.wav"); 
-    if (!gameOverSound) {
-        cout << "Error loading game over sound: " << Mix_GetError() << endl;
     }
+    renderQueue.reserve(sdl.renderer.get(), sdl.spriteAtlas.get(), BOARD_CELLS + 64);
+ }
 
-    eatingSound = Mix_LoadWAV("sound/eating.wav");
-     if (!eatingSound) 
+    // SDL without a window: a software renderer drawing into an offscreen
+    // surface, for benchReplays and runStress. No audio or telemetry.
+    void startOffscreen()
     {
-    cout << "Error loading eating sound: " << Mix_GetError() << endl;
-    }
-
-    bonusSound = Mix_LoadWAV("sound/bonus.wav");
-
-        window = SDL_CreateWindow("Simple Snake Game",
-                                SDL_WINDOWPOS_CENTERED,
-                                SDL_WINDOWPOS_CENTERED,
-                                SCREEN_WIDTH,
-                                SCREEN_HEIGHT,
-                                SDL_WINDOW_SHOWN);
-
-        if (!window)
-         {
-            cout << "Window could not be created! SDL_Error: " << SDL_GetError() << endl;
-            exit(1);
-         }
-
-        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-        if (!renderer) 
-        {
-            cout << "Renderer could not be created! SDL_Error: " << SDL_GetError() << endl;
-            exit(1);
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+        // Same singletons as suruKor touches, for cleanupSDL.
+        audio();
+        uiCache();
+        leaderboard();
+        scoreSync();
+        atexit(cleanupSDL);
+        initLibraries();
+
+        sdl.offscreen = ownSurface(SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888));
+        if (sdl.offscreen) {
+            sdl.renderer = RendererHandle(SDL_CreateSoftwareRenderer(sdl.offscreen.get()));
         }
-
-        font = TTF_OpenFont("fonts/atop-font.ttf", 24); 
-        if (!font) 
+        if (!sdl.renderer)
         {
-            cout << "Failed to load font! SDL_ttf Error: " << TTF_GetError() << endl;
+            cout << "Offscreen renderer could not be created! SDL_Error: " << SDL_GetError() << endl;
             exit(1);
         }
-
-        
-    SDL_Surface* appleSurface = IMG_Load("image/apple.png");
-    if (!appleSurface) {
-        cout << "Failed to load apple image: " << IMG_GetError() << endl;
-        exit(1);
+        loadAssets();
     }
-    appleTexture = SDL_CreateTextureFromSurface(renderer, appleSurface);
-    SDL_FreeSurface(appleSurface);
 
-    if (!appleTexture) 
+    // Re-simulates every recorded game in dir (version 2 replays of this
+    // layout) from its seed and inputs, drawing each tick offscreen with
+    // renderGame, and prints the tick and frame latency. The PGO build is
+    // trained on this, and the Makefile's linux-bench target times it for
+    // each build variant.
+    int benchReplays(const string& dir)
     {
-        cout << "Failed to create apple texture: " << SDL_GetError() << endl;
-        exit(1);
-    }
+        startOffscreen();
 
-     SDL_Surface* snakeHeadSurface = IMG_Load("image/snake_head.png");
-    if (!snakeHeadSurface) {
-        cout << "Failed to load snake head image: " << IMG_GetError() << endl;
-        exit(1);
-    }
-    snakeHeadTexture = SDL_CreateTextureFromSurface(renderer, snakeHeadSurface);
-    SDL_FreeSurface(snakeHeadSurface);
+        vector<string> paths;
+        error_code ec;
+        for (const auto& entry : filesystem::directory_iterator(dir, ec)) {
+            if (entry.path().extension() == ".replay") {
+                paths.push_back(entry.path().string());
+            }
+        }
+        sort(paths.begin(), paths.end());
+
+        int games = 0, diverged = 0;
+        TimingStats tickTime, frameTime;
+        for (const string& path : paths) {
+            ReplayPlayer recording;
+            if (!recording.load(path) || recording.header.version < 2 || recording.header.layout != LAYOUT_MAZE) {
+                continue;
+            }
+            Arena& arena = gameArena();
+            arena.reset();
+            SnakeCore core(arena, RULES, recording.header.seed);
+            Simulation sim;
+            allocateSnapshots(sim, arena);
+            publishSnapshot(sim, core, 0);
+            games++;
+
+            // Frame 0 is the starting position; every later frame holds the
+            // input of the tick that produced it.
+            for (size_t f = 1; f < recording.frames.size() && !core.over(); f++) {
+                const ReplayFrame& recorded = recording.frames[f];
+                int packed = replayDirection(recorded.input);
+                timedTick(sim, core, (packed / 3 - 1) * SQUARE_SIZE, (packed % 3 - 1) * SQUARE_SIZE, replayContinues(recorded.input),
+                          tickTime, frameTime);
+                if (core.body()[0].x != recorded.headX || core.body()[0].y != recorded.headY) {
+                    cout << path << " diverges from its recording at frame " << f << endl;
+                    diverged++;
+                    break;
+                }
+            }
+        }
 
-    if (!snakeHeadTexture) {
-        cout << "Failed to create snake head texture: " << SDL_GetError() << endl;
-        exit(1);
+        cout << "Replayed " << games << " games" << (diverged ? ", " + to_string(diverged) + " diverged" : "") << endl;
+        tickTime.print(cout, "sim tick");
+        frameTime.print(cout, "render frame");
+        cleanupSDL();
+        return games > 0 && diverged == 0 ? 0 : 1;
     }
 
-    SDL_Surface* bonusFoodSurface = IMG_Load("image/apple.png");
-    if (!bonusFoodSurface) 
+    // Runs a stress.h scenario for the given number of ticks, drawn
+    // offscreen like benchReplays, and prints the tick and frame latency.
+    // Restarts between games are not timed.
+    int runStress(const string& name, int ticks)
     {
-        cout << "Failed to load bonus food image: " << IMG_GetError() << endl;
-        exit(1);
+        int scenario = stressScenario(name);
+        if (scenario < 0 || !stressFits((StressScenario)scenario, RULES)) {
+            cout << "Unknown stress scenario " << name << "; this game runs:";
+            for (int i = 0; i < STRESS_COUNT; i++) {
+                if (stressFits((StressScenario)i, RULES)) {
+                    cout << " " << STRESS_NAMES[i];
+                }
+            }
+            cout << endl;
+            return 1;
+        }
+        startOffscreen();
+
+        StressDriver driver(RULES, (StressScenario)scenario, 1);
+        Arena& arena = gameArena();
+        arena.reset();
+        Simulation sim;
+        allocateSnapshots(sim, arena);
+        TimingStats tickTime, frameTime;
+        for (int i = 0; i < ticks; i++) {
+            driver.restartIfDone();
+            int dx, dy, continues;
+            driver.nextInput(dx, dy, continues);
+            timedTick(sim, driver.core(), dx, dy, continues, tickTime, frameTime);
+        }
+
+        cout << "Stress " << name << ": " << ticks << " ticks, " << driver.restarts() << " restarts" << endl;
+        tickTime.print(cout, "sim tick");
+        frameTime.print(cout, "render frame");
+        if (rewindEnabled) {
+            sim.rewind.print(cout);
+        }
+        cleanupSDL();
+        return 0;
     }
-    bonusFoodTexture = SDL_CreateTextureFromSurface(renderer, bonusFoodSurface);
-    SDL_FreeSurface(bonusFoodSurface);
 
-    if (!bonusFoodTexture) 
+    // One tick and one frame outside the game loop, each timed on its own.
+    void timedTick(Simulation& sim, SnakeCore& core, int dx, int dy, int continues, TimingStats& tickTime, TimingStats& frameTime)
     {
-        cout << "Failed to create bonus food texture: " << SDL_GetError() << endl;
-        exit(1);
+        auto start = chrono::steady_clock::now();
+        stepCore(sim, core, dx, dy, continues);
+        publishSnapshot(sim, core, replayInput(packDirection(dx, dy), continues));
+        auto simulated = chrono::steady_clock::now();
+        sim.frames.update();
+        renderGame(sdl.renderer.get(), sim.frames.front(), sdl.font.get(), sdl.spriteAtlas.get());
+        tickTime.record(elapsedNanos(start, simulated));
+        frameTime.record(elapsedNanos(simulated, chrono::steady_clock::now()));
     }
- }
 
-
-
-    void cobiDekha(SDL_Renderer* renderer, const char* imagePath,int displayTimeMs)
+    // One core tick, kept for rewind unless --no-rewind.
+    void stepCore(Simulation& sim, SnakeCore& core, int dx, int dy, int continues)
     {
-        SDL_Surface* surface = IMG_Load(imagePath);
-        if (!surface) {
-            cout << "Error: Could not load image " << imagePath << " " << IMG_GetError() << endl;
+        if (!rewindEnabled) {
+            core.tick(dx, dy, continues);
             return;
         }
+        sim.rewind.beforeTick(core);
+        core.tick(dx, dy, continues);
+        sim.rewind.afterTick(core);
+    }
 
-        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_FreeSurface(surface);
-
-        SDL_RenderClear(renderer);
-        SDL_RenderCopy(renderer, texture, nullptr, nullptr);
-        SDL_RenderPresent(renderer);
-
-        SDL_Delay(displayTimeMs);
-
-        SDL_DestroyTexture(texture);
+    // The snapshot slots and the rewind ring.
+    void allocateSnapshots(Simulation& sim, Arena& arena)
+    {
+        for (int i = 0; i < 3; i++) {
+            sim.frames.slot(i).snake = arena.allocate<uint32_t>(BOARD_CELLS);
+            sim.frames.slot(i).entities.allocate(arena, BOARD_CELLS);
+        }
+        sim.rewind.begin(RULES, arena.allocate<RewindDelta>(REWIND_CAPACITY), REWIND_CAPACITY,
+                         arena.allocate<Segment>(BOARD_CELLS + REWIND_CAPACITY));
     }
 
 
 
-    void firstCobiDekha(SDL_Renderer* renderer, TTF_Font* font) 
+    bool firstCobiDekha(SDL_Renderer* renderer, TTF_Font* font) 
     {
-    Mix_Music* music = Mix_LoadMUS("sound/intro.mp3");
-
-    if (music == nullptr)
-     {
-         cout << "Error loading music: " << Mix_GetError() << endl;
-     }
-     else
-     {
-        Mix_PlayMusic(music, -1);  
-     }
+        if (injector) {
+            return injector->active();
+        }
+        // Starts once the device is open, if the cover is still up by then.
+        audio().playMusic();
 
-        cobiDekha(renderer, "image/cover.png", 0);
+        Menu menu;
+        menu.background = uiCache().image(renderer, "image/cover.png");
+        menu.onFirstPresent = firstFrameShown;
 
-        
         SDL_Rect playButtonRect = {SCREEN_WIDTH / 2 - 100, SCREEN_HEIGHT / 2 +15, 200, 50};
         SDL_Rect quitButtonRect = {SCREEN_WIDTH / 2 - 100, SCREEN_HEIGHT / 2 +75, 200, 50}; 
 
         SDL_Color buttonColor = {0, 0,200, 255}; 
-        SDL_Color textColor = {255, 255, 255, 255}; 
-
-        bool introDone = false;
-    
-        while (!introDone) 
-        {
-            SDL_Event event;
 
-            
-            SDL_SetRenderDrawColor(renderer, buttonColor.r, buttonColor.g, buttonColor.b, buttonColor.a);
-            SDL_RenderFillRect(renderer, &playButtonRect);
-            renderText(renderer, font, "Play Game", playButtonRect.x + 50, playButtonRect.y + 10);
-
-            SDL_RenderFillRect(renderer, &quitButtonRect);
-            renderText(renderer, font, "Quit", quitButtonRect.x + 75, quitButtonRect.y + 10);
-
-            SDL_RenderPresent(renderer);
-        
-            while (SDL_PollEvent(&event))
-             {
-                if (event.type == SDL_QUIT) 
-                {
-                    exit(0); 
-                }
-
-                
-                if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT)
-                {
-                    int mouseX = event.button.x;
-                    int mouseY = event.button.y;
+        menu.addButton(renderer, font, playButtonRect, "Play Game", 50, 10, buttonColor);
+        menu.addButton(renderer, font, quitButtonRect, "Quit", 75, 10, buttonColor);
 
-                    
-                    if (mouseX >= playButtonRect.x && mouseX <= playButtonRect.x + playButtonRect.w &&
-                        mouseY >= playButtonRect.y && mouseY <= playButtonRect.y + playButtonRect.h)
-                        {
-                        introDone = true; 
-                         Mix_HaltMusic();
-                        }
+        if (menu.run(renderer) != 0)
+        {
+            return false;
+        }
+        audio().haltMusic();
+        return true;
+    }
 
-                  
-                    if (mouseX >= quitButtonRect.x && mouseX <= quitButtonRect.x + quitButtonRect.w &&
-                        mouseY >= quitButtonRect.y && mouseY <= quitButtonRect.y + quitButtonRect.h) 
-                        {
-                        exit(0);
-                       }
-                }
-            }
+    // The cover is on screen and clickable: report time-to-interactive
+    // (once per process) and only now start opening the audio device.
+    void firstFrameShown()
+    {
+        static bool reported = false;
+        if (!reported) {
+            reported = true;
+            cout << "Time to interactive: " << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - processStart).count()
+                 << " ms" << (audio().status() == AUDIO_SILENT ? " (audio disabled)" : "") << endl;
         }
+        audio().start();
     }
 
 
 
-    void sesCobiDekha(SDL_Renderer* renderer,TTF_Font* font,int score,int high_score)
+    bool sesCobiDekha(SDL_Renderer* renderer,TTF_Font* font,int score,int high_score,int length)
     {
-        cobiDekha(renderer, "image/gameover.png", 0); 
-        
-        bool introDone = false;
+        telemetry().log(EVENT_GAME_END, 0, 0, score, length);
+        if (injector) {
+            return injector->active();
+        }
 
         SDL_Rect RestartButtonRect = {SCREEN_WIDTH / 2 - 130, SCREEN_HEIGHT / 2 +110, 250, 50};
         SDL_Rect quitButtonRect = {SCREEN_WIDTH / 2 - 100, SCREEN_HEIGHT / 2 +170, 200, 50};
         
         SDL_Color buttonColor = {0, 0,0, 255}; 
-        SDL_Color textColor = {255, 255, 255, 255}; 
-
-         renderText(renderer, font, "Score: " + to_string(score), SCREEN_WIDTH / 2 - 70, 20);
-         renderText(renderer, font, "High Score: " + to_string(high_score), SCREEN_WIDTH / 2 - 100, 70);
-
-        
-        while (!introDone) {
-            SDL_Event event;
-
-            SDL_SetRenderDrawColor(renderer, buttonColor.r, buttonColor.g, buttonColor.b, buttonColor.a);
-            SDL_RenderFillRect(renderer, &RestartButtonRect);
-
-            renderText(renderer, font, "Restart Game", RestartButtonRect.x + 50, RestartButtonRect.y + 10);
-
-            SDL_RenderFillRect(renderer, &quitButtonRect);
-            renderText(renderer, font, "Quit", quitButtonRect.x + 75, quitButtonRect.y + 10);
 
-            SDL_RenderPresent(renderer);
-
-
-            while (SDL_PollEvent(&event)) {
-                if (event.type == SDL_QUIT) 
-                {
-                    introDone = true; 
-                }
-                
-                if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT)
-                {
-                    int mouseX = event.button.x;
-                    int mouseY = event.button.y;
-
-                    if (mouseX >= RestartButtonRect.x && mouseX <= RestartButtonRect.x + RestartButtonRect.w &&
-                        mouseY >= RestartButtonRect.y && mouseY <= RestartButtonRect.y + RestartButtonRect.h) {
-                        introDone = true; 
-                        main(0, nullptr);
-                    }
-
-                    if (mouseX >= quitButtonRect.x && mouseX <= quitButtonRect.x + quitButtonRect.w &&
-                        mouseY >= quitButtonRect.y && mouseY <= quitButtonRect.y + quitButtonRect.h) 
-                    {
-                        exit(0);
-                    }
-                }
-
-            }
-        }
+        Menu menu;
+        menu.background = uiCache().image(renderer, "image/gameover.png");
+        menu.addText(renderer, font, "Score: " + to_string(score), SCREEN_WIDTH / 2 - 70, 20);
+        menu.addText(renderer, font, "High Score: " + to_string(high_score), SCREEN_WIDTH / 2 - 100, 70);
+        menu.addButton(renderer, font, RestartButtonRect, "Restart Game", 50, 10, buttonColor);
+        menu.addButton(renderer, font, quitButtonRect, "Quit", 75, 10, buttonColor);
+        return menu.run(renderer) == 0;
     }
 
 
 
-    Segment khabarToiriKor() 
-    {
-        return {
-            rand() % ((SCREEN_WIDTH - 4 * SQUARE_SIZE) / SQUARE_SIZE) * SQUARE_SIZE + SQUARE_SIZE,
-            rand() % ((SCREEN_HEIGHT - 4 * SQUARE_SIZE) / SQUARE_SIZE) * SQUARE_SIZE + SQUARE_SIZE
-        };
-    }
-
-
     void handleEvents(bool& quit, int& dx, int& dy) 
     {
         SDL_Event event;
@@ -397,6 +660,7 @@
                 switch (event.key.keysym.sym)
                 {
                     case SDLK_UP:
+                        autopilotOn = false;
                         if (dy == 0) 
                         {
                             dx = 0;
@@ -404,6 +668,7 @@
                         }
                         break;
                     case SDLK_DOWN:
+                        autopilotOn = false;
                         if (dy == 0)
                         {
                             dx = 0;
@@ -411,6 +676,7 @@
                         }
                         break;
                     case SDLK_LEFT:
+                        autopilotOn = false;
                         if (dx == 0) 
                         {
                             dx = -SQUARE_SIZE;
@@ -418,22 +684,34 @@
                         }
                         break;
                     case SDLK_RIGHT:
+                        autopilotOn = false;
                         if (dx == 0) 
                         {
                             dx = SQUARE_SIZE;
                             dy = 0;
                         }
                         break;
+                    case SDLK_F2:
+                        toggleAutopilot();
+                        break;
+                    case SDLK_F3:
+                        showLatency = !showLatency;
+                        break;
 
                     case SDLK_y:
                     {
-                        paused=false;
-                        score-=10;
-                        
+                        // Applied by the simulation thread, which owns the score.
+                        continueRequests++;
                         break;
                         
                     }
 
+                    case SDLK_r:
+                    {
+                        rewindRequests++;
+                        break;
+                    }
+
                     case SDLK_n:
                     {
                         quit=true;
@@ -444,237 +722,246 @@
     }
 
 
-    bool checkCollision(const Segment& a, const Segment& b) 
+    int packDirection(int dx, int dy)
     {
-        return a.x == b.x && a.y == b.y;
+        return (dx / SQUARE_SIZE + 1) * 3 + dy / SQUARE_SIZE + 1;
     }
 
-    bool checkBonusCollision(const Segment& a, const Segment& b)
-     {
-    const int BONUS_FOOD_SIZE = 20; 
-    return abs(a.x - b.x) < BONUS_FOOD_SIZE && abs(a.y - b.y) < BONUS_FOOD_SIZE;
+    // The autopilot's move for the next tick, packed.
+    int autopilotDirection(const SnakeCore& core)
+    {
+        uint32_t targets[2];
+        int count = 0;
+        targets[count++] = core.food().y / SQUARE_SIZE * BOARD_COLS + core.food().x / SQUARE_SIZE;
+        if (core.bonusActive()) {
+            targets[count++] = core.bonus().y / SQUARE_SIZE * BOARD_COLS + core.bonus().x / SQUARE_SIZE;
+        }
+        uint32_t head = core.body().cellAt(0);
+        uint32_t next = autopilot.nextCell(core.body(), targets, count);
+        return packDirection(((int)(next % BOARD_COLS) - (int)(head % BOARD_COLS)) * SQUARE_SIZE,
+                             ((int)(next / BOARD_COLS) - (int)(head / BOARD_COLS)) * SQUARE_SIZE);
     }
 
-
-
-
-    void moveSnake(vector<Segment>& snake, int dx, int dy, Segment& food, bool& foodEaten, bool& quit, int& score)
+    void toggleAutopilot()
     {
+        if (boardCycle.empty()) {
+            cout << "No Hamiltonian cycle on this board, so no autopilot" << endl;
+            return;
+        }
+        autopilotOn = !autopilotOn;
+        cout << "Autopilot " << (autopilotOn ? "on" : "off") << endl;
+    }
 
-
-     if(paused==true)
-     {
-        return;
-     }
-    
-        Segment newHead = {snake[0].x + dx, snake[0].y + dy};
-        snake.insert(snake.begin(), newHead);
-
-        
-        if (checkCollision(snake[0], food)) 
-        {
-            foodEaten = true;
-            score += 10; 
-             foodCounter++;
-
-            if (eatingSound) 
-            {
-            Mix_PlayChannel(-1, eatingSound, 0);
+    void runSimulation(Simulation& sim, SnakeCore& core)
+    {
+        const auto period = chrono::milliseconds(SNAKE_SPEED);
+        auto next = chrono::steady_clock::now() + period;
+        uint32_t checkedTicks = 0;
+
+        // After a death the game waits for r (or n) while there is
+        // something to rewind; unattended runs end there as before.
+        while (!sim.stop && (!core.over() || (rewindEnabled && !injector && sim.rewind.size() > 0))) {
+            this_thread::sleep_until(next);
+            auto start = chrono::steady_clock::now();
+            sim.tickJitter.record(elapsedNanos(next, start));
+            next += period;
+            if (next < start) {
+                next = start + period;
             }
+            SteadyStateCheck check("tick", checkedTicks);
 
-           if (!bonusFoodActive && foodCounter % 2 == 0)
-           {
-            bonusFood = khabarToiriKor();
-            Mix_PlayChannel(-1, bonusSound, 0);
-
-            foodCounter=0;
-            bonusFoodActive = true;
-            bonusFoodStartTime = SDL_GetTicks();
-           }
-
-           if (bonusFoodActive && SDL_GetTicks() - bonusFoodStartTime > BONUS_FOOD_DURATION)
-            {
-              bonusFood = khabarToiriKor();
-            Mix_PlayChannel(-1, bonusSound, 0);
-
-            foodCounter=0;
-            bonusFoodActive = true;
-            bonusFoodStartTime = SDL_GetTicks();
-            
-           }
-        } 
+            uint32_t input = sim.input;
+            int packed = input & 15;
+            if (input >> 4 != sim.inputSeq) {
+                sim.inputSeq = input >> 4;
+                sim.inputAppliedAt = start;
+            }
+            if (autopilotOn && !core.over()) {
+                packed = autopilotDirection(core);
+                sim.steeredDirection = packed;
+            }
+            int dx = (packed / 3 - 1) * SQUARE_SIZE;
+            int dy = (packed % 3 - 1) * SQUARE_SIZE;
+            int continues = continueRequests.exchange(0);
+
+            // A rewind takes this tick's place, so the main thread can pick
+            // up the direction the snake had then before it moves again.
+            int rewinds = rewindRequests.exchange(0);
+            if (rewinds > 0 && sim.rewind.rewind(core, rewinds * REWIND_TICKS) > 0) {
+                const SnakeBody<Segment>& snake = core.body();
+                if (snake.size() > 1) {
+                    sim.rewoundDirection = packDirection(snake[0].x - snake[1].x, snake[0].y - snake[1].y);
+                }
+                sim.rewound = true;
+                telemetry().log(EVENT_REWIND, snake[0].x, snake[0].y, core.score(), snake.size());
+                publishSnapshot(sim, core, 0);
+                continue;
+            }
+            if (core.over()) {
+                continue;
+            }
 
-        else if (bonusFoodActive && checkBonusCollision(snake[0], bonusFood))
-         {
-        score += 50; 
-        bonusFoodActive = false; 
-        if (eatingSound) 
-         {
-            Mix_PlayChannel(-1, eatingSound, 0);
-         }
-        } 
-        else
-        {
-            snake.pop_back();
-        }
+            stepCore(sim, core, dx, dy, continues);
+            reportEvents(core);
 
-    
-        for (size_t i = 1; i < snake.size(); i++) 
-        {
-            if (checkCollision(snake[0], snake[i])) 
-            {
-                quit = true;
-                foodCounter=0;
-                break;
+            publishSnapshot(sim, core, replayInput(packed, continues));
+            sim.tickWork.record(elapsedNanos(start, chrono::steady_clock::now()));
+            if (showLatency && sim.tickWork.count() % 8 == 0) {
+                sim.tickP99Ns = sim.tickWork.percentileNs(0.99);
             }
         }
+        sim.finished = true;
+    }
 
-      
-        if (snake[0].x < SQUARE_SIZE || snake[0].x >= SCREEN_WIDTH - SQUARE_SIZE ||
-            snake[0].y < SQUARE_SIZE || snake[0].y >= SCREEN_HEIGHT - SQUARE_SIZE) 
-            {
-            foodCounter=0;
-            quit = true;
+    // Telemetry and sounds for what the last tick did.
+    void reportEvents(const SnakeCore& core)
+    {
+        if (core.moved()) {
+            telemetry().advanceTick();
+        }
+        for (int i = 0; i < core.eventCount(); i++) {
+            const CoreEvent& e = core.events()[i];
+            telemetry().log(e.type, e.x, e.y, e.score, e.length, e.cause);
+            if (e.type == EVENT_FOOD_EATEN || e.type == EVENT_BONUS_EATEN) {
+                audio().play(SOUND_EATING);
+            } else if (e.type == EVENT_BONUS_SPAWN) {
+                audio().play(SOUND_BONUS);
+            } else if (e.type == EVENT_DEATH && e.cause != CAUSE_MAZE_WALL) {
+                audio().play(SOUND_GAME_OVER);
             }
+        }
+    }
 
-       
-
-
-        if (quit && gameOverSound) 
-        {
-        Mix_PlayChannel(-1, gameOverSound, 0); 
-       }
-
-        if (snake[0].x <100 || snake[0].x >= 600 ||
-            snake[0].y < SQUARE_SIZE || snake[0].y >= SCREEN_HEIGHT - SQUARE_SIZE) 
-            {
-            paused=true;
-            }
-    
+    // input is what the tick just run was given, for the replay.
+    void publishSnapshot(Simulation& sim, const SnakeCore& core, uint8_t input)
+    {
+        const SnakeBody<Segment>& snake = core.body();
+        GameSnapshot& frame = sim.frames.back();
+        uint32_t* cells = frame.snake;
+        snake.forEachCell([&](uint32_t cell) { *cells++ = cell; });
+        frame.length = (int)snake.size();
+        frame.entities.copyFrom(core.entities().columns());
+        frame.score = core.score();
+        frame.tickP99Ns = sim.tickP99Ns;
+        frame.inputSeq = sim.inputSeq;
+        frame.inputAppliedAt = sim.inputAppliedAt;
+        frame.paused = core.isPaused();
+        frame.over = core.over();
+        sim.frames.publish();
+        sim.replay.record(snake, core.food(), core.bonus(), core.bonusActive(), core.score(), input);
     }
 
-    void renderGame(SDL_Renderer* renderer, const vector<Segment>& snake, const Segment& food, TTF_Font* font, int score,SDL_Texture* appleTexture)
+    void renderGame(SDL_Renderer* renderer, const GameSnapshot& frame, TTF_Font* font, SDL_Texture* spriteAtlas)
      {
+        const uint32_t* snake = frame.snake;
+        const EntityColumns& entities = frame.entities;
+
+        logicalScreen().begin(renderer);
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
 
-        SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
-        SDL_Rect walls[] = {
-            {0, 0, SCREEN_WIDTH, SQUARE_SIZE},
-            {0, SCREEN_HEIGHT - SQUARE_SIZE, SCREEN_WIDTH, SQUARE_SIZE},
-            {0, 0, SQUARE_SIZE, SCREEN_HEIGHT},
-            {SCREEN_WIDTH - SQUARE_SIZE, 0, SQUARE_SIZE, SCREEN_HEIGHT}
-        };
-
-        for (const auto& wall : walls) 
-        {
-            SDL_RenderFillRect(renderer, &wall);
-        }
-
-         SDL_SetRenderDrawColor(renderer, 0, 0, 255, 255);
-        SDL_Rect walls2[] = {
-            {500, 80,100 , SQUARE_SIZE},
-            {580, 80, SQUARE_SIZE, 300},
-            {100, 80, SQUARE_SIZE, 300},
-            {100, 380,80, SQUARE_SIZE}
-        };
+        renderQueue.clear();
 
-        for (const auto& wall : walls2) 
+        // Walls, food and bonuses in one pass over the entity columns.
+        SDL_Color wallColor = {0, 0, 255, 255};
+        for (int i = 0; i < entities.count; i++) 
         {
-            SDL_RenderFillRect(renderer, &wall);
-        }
-
-       
-        SDL_Rect foodRect = {food.x, food.y, SQUARE_SIZE, SQUARE_SIZE};
-       SDL_RenderCopy(renderer, appleTexture, nullptr, &foodRect);
-
-         if (bonusFoodActive) 
-         {
-        SDL_Rect bonusFoodRect = {bonusFood.x, bonusFood.y, BONUS_FOOD_SIZE, BONUS_FOOD_SIZE};
-        SDL_RenderCopy(renderer, bonusFoodTexture, nullptr, &bonusFoodRect);
+            int x = entities.cell[i] % BOARD_COLS * SQUARE_SIZE;
+            int y = entities.cell[i] / BOARD_COLS * SQUARE_SIZE;
+            if (entities.type[i] == ENTITY_WALL) 
+            {
+                SDL_Rect wallRect = {x, y, entities.width[i] * SQUARE_SIZE, entities.height[i] * SQUARE_SIZE};
+                renderQueue.add(SPRITE_SOLID, wallRect, wallColor);
+            } 
+            else 
+            {
+                int size = entities.type[i] == ENTITY_BONUS ? BONUS_FOOD_SIZE : SQUARE_SIZE;
+                SDL_Rect foodRect = {x, y, size, size};
+                renderQueue.add(SPRITE_APPLE, foodRect);
+            }
         }
 
 
-     SDL_Rect headRect = {snake[0].x, snake[0].y, SQUARE_SIZE, SQUARE_SIZE};
-     SDL_RenderCopy(renderer, snakeHeadTexture, nullptr, &headRect);
+     SDL_Rect headRect = {(int)(snake[0] % BOARD_COLS) * SQUARE_SIZE, (int)(snake[0] / BOARD_COLS) * SQUARE_SIZE, SQUARE_SIZE, SQUARE_SIZE};
+     renderQueue.add(SPRITE_HEAD, headRect);
 
    
-SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); 
+SDL_Color bodyColor = {0, 255, 0, 255};
 
+for (int i = 1; i < frame.length; ++i) 
+{
+    SDL_Rect bodyRect = {(int)(snake[i] % BOARD_COLS) * SQUARE_SIZE, (int)(snake[i] / BOARD_COLS) * SQUARE_SIZE, SQUARE_SIZE, SQUARE_SIZE};
+    renderQueue.add(SPRITE_BODY, bodyRect, bodyColor);
+}
 
-auto drawCircle = [&](int centerX, int centerY, int radius) {
-    for (int y = -radius; y <= radius; ++y) {
-        for (int x = -radius; x <= radius; ++x) {
-            if (x * x + y * y <= radius * radius) {
-                SDL_RenderDrawPoint(renderer, centerX + x, centerY + y);
-            }
+        char scoreText[32];
+        snprintf(scoreText, sizeof(scoreText), "Score: %d", frame.score);
+        renderQueue.addText(atlasGlyphs, scoreText, 500, 0);
+        if (showLatency) {
+            char latencyText[64];
+            snprintf(latencyText, sizeof(latencyText), "tick p99 %.1fus  frame p99 %.1fus", frame.tickP99Ns / 1000.0, frameP99Ns / 1000.0);
+            renderQueue.addText(atlasGlyphs, latencyText, 10, SCREEN_HEIGHT - 30);
+        }
+        if (frame.paused || frame.over) {
+            const char* keys = frame.over ? "r rewind  n quit" : rewindEnabled ? "y continue  r rewind  n quit" : "y continue  n quit";
+            renderQueue.addText(atlasGlyphs, keys, SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 2);
         }
-    }
-};
-
 
-for (size_t i = 1; i < snake.size(); ++i) 
-{
-    drawCircle(snake[i].x + SQUARE_SIZE / 2, snake[i].y + SQUARE_SIZE / 2, SQUARE_SIZE / 2);
-}
-       
-        renderText(renderer, font, "Score: " + to_string(score), 500, 0);
+        renderQueue.submit(renderer, spriteAtlas);
 
-        SDL_RenderPresent(renderer);
+        logicalScreen().present(renderer);
  }
 
   
-    void renderText(SDL_Renderer* renderer, TTF_Font* font, const string& text, int x, int y) {
-        SDL_Color white = {255, 255, 255, 255};
-        SDL_Surface* textSurface = TTF_RenderText_Solid(font, text.c_str(), white);
-        SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-
-        SDL_Rect textRect = {x, y, textSurface->w, textSurface->h};
-        SDL_RenderCopy(renderer, textTexture, nullptr, &textRect);
-
-        SDL_FreeSurface(textSurface);
-        SDL_DestroyTexture(textTexture);
-    }
-
-    void saveHighScore(int highScore) 
+    void saveHighScore(int score, int length) 
     {
-    std::ofstream outFile("highscore.txt"); 
-    if (outFile.is_open()) {
-        outFile << highScore; 
-        outFile.close();  
+        leaderboard().submit(score, length);
     }
-     else 
-    {
-        cout << "Error: Could not open highscore file for writing!" << endl;
-    }
-   }
 
 int loadHighScore()
  {
-    std::ifstream inFile("highscore.txt"); 
-    int highScore = 0;
-
-    if (inFile.is_open())
-     {
-        inFile >> highScore;  
-        inFile.close(); 
-     }
-
-    return highScore; 
+    return leaderboard().topScore(); 
 }
 
 
-    void cleanupSDL(SDL_Window* window, SDL_Renderer* renderer, TTF_Font* font,SDL_Texture* appleTexturet) {
-        TTF_CloseFont(font);
-         SDL_DestroyTexture(appleTexture);
-         SDL_DestroyTexture(snakeHeadTexture);
-         SDL_DestroyTexture(bonusFoodTexture);
-        Mix_FreeChunk(gameOverSound);
-        Mix_FreeChunk(eatingSound);
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
+    // Also registered with atexit, so the exit(1) paths release everything
+    // too; the second call finds nothing left to do.
+    void cleanupSDL() {
+        static bool done = false;
+        if (done) {
+            return;
+        }
+        done = true;
+        sdl.font.reset();
+        uiCache().clear();
+        sdl.spriteAtlas.reset();
+        logicalScreen().detach();
+        sdl.renderer.reset();
+        sdl.offscreen.reset();
+        sdl.window.reset();
         TTF_Quit();
         IMG_Quit();
-        Mix_Quit(); 
+        audio().shutdown();
         SDL_Quit();
-    }
\ No newline at end of file
+        leaderboard().flush();
+        scoreSync().stop();
+        scoreSync().report(cout);
+        resources().report(cout, "at exit");
+    }
+
+    // Everything one game needs, sized from the board: the game core, three
+    // snapshots, the replay frames, the rewind ring and the body of a
+    // resumed save. Reset, not freed, when a new game starts.
+    Arena& gameArena()
+    {
+        const size_t bytes = SnakeCore::bytesFor(RULES) + 3 * (BOARD_CELLS * sizeof(uint32_t) + EntityColumns::bytesFor(BOARD_CELLS)) +
+                             REPLAY_MAX_FRAMES * sizeof(ReplayFrame) + RewindBuffer::bytesFor(RULES, REWIND_CAPACITY) +
+                             BOARD_CELLS * sizeof(Segment) + 256;
+        static Arena arena(bytes);
+        static bool registered = false;
+        if (!registered) {
+            resources().add(RES_GAME_STATE, bytes);
+            registered = true;
+        }
+        return arena;
+    }
@@ -0,0 +1,208 @@
+#pragma once
+
+// Per-game telemetry. The game thread writes fixed-size events into a
+// preallocated single-producer ring; a background thread drains it into
+// the append-only binary log telemetry.bin. Logging an event never
+// allocates, locks or touches the disk; if the ring is ever full the
+// event is dropped and counted instead.
+// Convert a log to CSV with the telemetry2csv tool.
+
+#include <bits/stdc++.h>
+
+const char* const TELEMETRY_FILE = "telemetry.bin";
+const uint32_t TELEMETRY_MAGIC = 0x4D4C5453; // "STLM"
+const uint32_t TELEMETRY_VERSION = 1;
+const size_t TELEMETRY_RING_SIZE = 8192; // must be a power of two
+const int TELEMETRY_FLUSH_MS = 50;
+
+enum TelemetryEventType : uint16_t {
+    EVENT_GAME_START = 1,
+    EVENT_FOOD_EATEN,
+    EVENT_BONUS_SPAWN,
+    EVENT_BONUS_EXPIRE,
+    EVENT_BONUS_EATEN,
+    EVENT_DEATH,
+    EVENT_GAME_END,
+    EVENT_CONTINUE,
+    EVENT_REWIND,
+};
+
+enum TelemetryDeathCause : uint16_t {
+    CAUSE_NONE = 0,
+    CAUSE_BORDER_WALL,
+    CAUSE_SELF,
+    CAUSE_MAZE_WALL,
+};
+
+struct TelemetryEvent {
+    uint64_t timeUs;  // since the process started
+    uint32_t session; // wall-clock seconds when the process started
+    uint32_t game;    // game number within the session
+    uint32_t tick;
+    uint16_t type;
+    uint16_t cause;
+    int32_t x, y;
+    int32_t score;
+    int32_t length;
+};
+
+struct TelemetryFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t eventSize;
+};
+
+inline const char* telemetryEventName(uint16_t type)
+{
+    switch (type) {
+        case EVENT_GAME_START: return "game_start";
+        case EVENT_FOOD_EATEN: return "food_eaten";
+        case EVENT_BONUS_SPAWN: return "bonus_spawn";
+        case EVENT_BONUS_EXPIRE: return "bonus_expire";
+        case EVENT_BONUS_EATEN: return "bonus_eaten";
+        case EVENT_DEATH: return "death";
+        case EVENT_GAME_END: return "game_end";
+        case EVENT_CONTINUE: return "continue";
+        case EVENT_REWIND: return "rewind";
+    }
+    return "unknown";
+}
+
+inline const char* telemetryCauseName(uint16_t cause)
+{
+    switch (cause) {
+        case CAUSE_BORDER_WALL: return "border_wall";
+        case CAUSE_SELF: return "self";
+        case CAUSE_MAZE_WALL: return "maze_wall";
+    }
+    return "";
+}
+
+class TelemetryLog {
+public:
+    explicit TelemetryLog(const char* path = TELEMETRY_FILE)
+        : path(path),
+          startTime(std::chrono::steady_clock::now()),
+          session((uint32_t)time(nullptr))
+    {
+        writer = std::thread(&TelemetryLog::writerLoop, this);
+    }
+
+    ~TelemetryLog()
+    {
+        stopping = true;
+        writer.join();
+    }
+
+    void beginGame()
+    {
+        game++;
+        tick = 0;
+    }
+
+    void advanceTick()
+    {
+        tick++;
+    }
+
+    void log(uint16_t type, int x, int y, int score, int length, uint16_t cause = CAUSE_NONE)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == TELEMETRY_RING_SIZE) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        TelemetryEvent& e = ring[h & (TELEMETRY_RING_SIZE - 1)];
+        e.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+        e.session = session;
+        e.game = game;
+        e.tick = tick;
+        e.type = type;
+        e.cause = cause;
+        e.x = x;
+        e.y = y;
+        e.score = score;
+        e.length = length;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    uint64_t droppedEvents() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::string path;
+    std::chrono::steady_clock::time_point startTime;
+    uint32_t session;
+    uint32_t game = 0;
+    uint32_t tick = 0;
+
+    TelemetryEvent ring[TELEMETRY_RING_SIZE];
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+    std::atomic<uint64_t> dropped{0};
+
+    std::atomic<bool> stopping{false};
+    std::thread writer;
+    FILE* file = nullptr;
+
+    void writerLoop()
+    {
+        while (!stopping.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(TELEMETRY_FLUSH_MS));
+            drain();
+        }
+        drain();
+        if (file) {
+            fclose(file);
+        }
+    }
+
+    void drain()
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        if (t == h || !open()) {
+            return;
+        }
+
+        while (t != h) {
+            // Write the contiguous run up to the end of the ring in one call.
+            size_t first = t & (TELEMETRY_RING_SIZE - 1);
+            size_t count = std::min(h - t, TELEMETRY_RING_SIZE - first);
+            fwrite(&ring[first], sizeof(TelemetryEvent), count, file);
+            t += count;
+        }
+        tail.store(t, std::memory_order_release);
+        fflush(file);
+    }
+
+    bool open()
+    {
+        if (file) {
+            return true;
+        }
+
+        file = fopen(path.c_str(), "ab");
+        if (!file) {
+            std::cout << "Error: Could not open telemetry log " << path << std::endl;
+            stopping = true;
+            return false;
+        }
+
+        fseek(file, 0, SEEK_END);
+        if (ftell(file) == 0) {
+            TelemetryFileHeader header = {TELEMETRY_MAGIC, TELEMETRY_VERSION, sizeof(TelemetryEvent)};
+            fwrite(&header, sizeof(header), 1, file);
+        }
+        return true;
+    }
+};
+
+inline TelemetryLog& telemetry()
+{
+    static TelemetryLog log;
+    return log;
+}
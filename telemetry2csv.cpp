@@ -0,0 +1,84 @@
+#include <bits/stdc++.h>
+#include "telemetry.h"
+
+using namespace std;
+
+// Converts telemetry.bin logs into CSV.
+//   telemetry2csv [log.bin ...] > events.csv
+//   telemetry2csv --bench          measures the game-thread cost of one event
+
+int convertLog(const char* path, bool writeHeader)
+{
+    ifstream inFile(path, ios::binary);
+    if (!inFile.is_open()) {
+        cerr << "Error: Could not open " << path << endl;
+        return 1;
+    }
+
+    TelemetryFileHeader header;
+    if (!inFile.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != TELEMETRY_MAGIC || header.version != TELEMETRY_VERSION ||
+        header.eventSize != sizeof(TelemetryEvent)) {
+        cerr << "Error: " << path << " is not a telemetry log this tool understands" << endl;
+        return 1;
+    }
+
+    if (writeHeader) {
+        cout << "session,game,tick,time_us,event,cause,x,y,score,length\n";
+    }
+
+    TelemetryEvent e;
+    while (inFile.read(reinterpret_cast<char*>(&e), sizeof(e))) {
+        cout << e.session << ',' << e.game << ',' << e.tick << ',' << e.timeUs << ','
+             << telemetryEventName(e.type) << ',' << telemetryCauseName(e.cause) << ','
+             << e.x << ',' << e.y << ',' << e.score << ',' << e.length << '\n';
+    }
+
+    if (inFile.gcount() != 0) {
+        cerr << "Warning: " << path << " ends with a partial event, ignored" << endl;
+    }
+    return 0;
+}
+
+int bench()
+{
+    const int EVENTS = 1000000;
+    const char* path = "telemetry_bench.bin";
+    uint64_t slowest = 0;
+    double total = 0;
+
+    {
+        TelemetryLog log(path);
+        log.beginGame();
+        for (int i = 0; i < EVENTS; i++) {
+            auto start = chrono::steady_clock::now();
+            log.log(EVENT_FOOD_EATEN, i, i, i, i);
+            auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+            total += ns;
+            slowest = max<uint64_t>(slowest, ns);
+            log.advanceTick();
+        }
+        cout << "events: " << EVENTS << ", dropped: " << log.droppedEvents() << endl;
+    }
+    remove(path);
+
+    cout << "mean: " << total / EVENTS << " ns/event, max: " << slowest << " ns" << endl;
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        return bench();
+    }
+
+    if (argc < 2) {
+        return convertLog(TELEMETRY_FILE, true);
+    }
+
+    int rc = 0;
+    for (int i = 1; i < argc; i++) {
+        rc |= convertLog(argv[i], i == 1);
+    }
+    return rc;
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+// Hashed timer wheel counted in simulation ticks. A timer due at tick t
+// sits in slot t % TIMER_WHEEL_SLOTS; each advance() only walks the slot
+// for the new tick, so the per-tick cost does not grow with the number of
+// timers pending further out. Scheduling and cancelling unlink a node from
+// a doubly linked list. Timers due on the same tick fire in the order they
+// were scheduled, so a game driven by the same inputs fires the same
+// timers on the same ticks, which keeps replays exact. Nodes live in a
+// buffer handed in by the game, so nothing is allocated while it runs.
+
+#include <bits/stdc++.h>
+
+const int TIMER_WHEEL_SLOTS = 256; // power of two
+
+struct TimerNode {
+    uint32_t deadline;
+    uint32_t generation;
+    int kind;
+    int data;
+    int prev, next;
+    int list; // wheel slot, TIMER_DUE or TIMER_FREE
+};
+
+// Stays valid to pass to cancel() after the timer fired or was cancelled.
+struct TimerId {
+    int index = -1;
+    uint32_t generation = 0;
+};
+
+class TimerWheel {
+public:
+    // Drops every timer; the clock starts at `start`.
+    void reset(TimerNode* storage, int capacity, uint32_t start = 0)
+    {
+        nodes = storage;
+        nodeCount = capacity;
+        tick = start;
+        for (int i = 0; i <= TIMER_DUE; i++) {
+            heads[i] = tails[i] = -1;
+        }
+        freeHead = -1;
+        for (int i = capacity - 1; i >= 0; i--) {
+            nodes[i].list = TIMER_FREE;
+            nodes[i].next = freeHead;
+            freeHead = i;
+        }
+    }
+
+    uint32_t now() const
+    {
+        return tick;
+    }
+
+    // Fires delay ticks from now (at least one).
+    TimerId schedule(uint32_t delay, int kind, int data = 0)
+    {
+        if (freeHead < 0) {
+            std::cout << "Error: Timer wheel full (" << nodeCount << " timers)" << std::endl;
+            exit(1);
+        }
+        int i = freeHead;
+        freeHead = nodes[i].next;
+
+        TimerNode& node = nodes[i];
+        node.deadline = tick + std::max<uint32_t>(delay, 1);
+        node.kind = kind;
+        node.data = data;
+        append(node.deadline & (TIMER_WHEEL_SLOTS - 1), i);
+        return {i, node.generation};
+    }
+
+    bool pending(TimerId id) const
+    {
+        return id.index >= 0 && nodes[id.index].generation == id.generation && nodes[id.index].list != TIMER_FREE;
+    }
+
+    // Returns whether the timer was still pending.
+    bool cancel(TimerId& id)
+    {
+        bool wasPending = pending(id);
+        if (wasPending) {
+            unlink(id.index);
+            release(id.index);
+        }
+        id = {};
+        return wasPending;
+    }
+
+    // Moves to the next tick and calls fire(kind, data) for every timer due
+    // on it. fire may schedule and cancel timers.
+    template <class Fire>
+    void advance(Fire fire)
+    {
+        tick++;
+        int slot = tick & (TIMER_WHEEL_SLOTS - 1);
+        for (int i = heads[slot]; i >= 0;) {
+            int next = nodes[i].next;
+            if (nodes[i].deadline == tick) {
+                unlink(i);
+                append(TIMER_DUE, i);
+            }
+            i = next;
+        }
+        while (heads[TIMER_DUE] >= 0) {
+            int i = heads[TIMER_DUE];
+            unlink(i);
+            release(i);
+            fire(nodes[i].kind, nodes[i].data);
+        }
+    }
+
+private:
+    static const int TIMER_DUE = TIMER_WHEEL_SLOTS;
+    static const int TIMER_FREE = -1;
+
+    TimerNode* nodes = nullptr;
+    int nodeCount = 0;
+    uint32_t tick = 0;
+    int heads[TIMER_WHEEL_SLOTS + 1] = {};
+    int tails[TIMER_WHEEL_SLOTS + 1] = {};
+    int freeHead = -1;
+
+    void append(int list, int i)
+    {
+        TimerNode& node = nodes[i];
+        node.list = list;
+        node.prev = tails[list];
+        node.next = -1;
+        if (tails[list] >= 0) {
+            nodes[tails[list]].next = i;
+        } else {
+            heads[list] = i;
+        }
+        tails[list] = i;
+    }
+
+    void unlink(int i)
+    {
+        TimerNode& node = nodes[i];
+        if (node.prev >= 0) {
+            nodes[node.prev].next = node.next;
+        } else {
+            heads[node.list] = node.next;
+        }
+        if (node.next >= 0) {
+            nodes[node.next].prev = node.prev;
+        } else {
+            tails[node.list] = node.prev;
+        }
+    }
+
+    void release(int i)
+    {
+        nodes[i].generation++;
+        nodes[i].list = TIMER_FREE;
+        nodes[i].next = freeHead;
+        freeHead = i;
+    }
+};
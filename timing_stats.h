@@ -0,0 +1,98 @@
+#pragma once
+
+// Latency histogram in the HDR style: values below 128 ns get a bucket
+// each, and every power of two above that is split into 64 buckets, so any
+// sample from a nanosecond to over half an hour is kept to within 1.6%
+// without the bucket count growing with the range. That keeps the tail
+// (p99.9, max) as exact as the median, which an average or fixed-width
+// buckets would smear. Allocated once up front; recording is a bit scan
+// and a couple of adds, cheap enough for every tick or frame. An instance
+// is only ever written by one thread.
+
+#include <bits/stdc++.h>
+
+const int TIMING_SUB_BUCKETS = 64;  // per power of two
+const int TIMING_MAX_SHIFT = 34;    // largest value tracked is just under 2^41 ns
+const int TIMING_BUCKETS = 2 * TIMING_SUB_BUCKETS + TIMING_MAX_SHIFT * TIMING_SUB_BUCKETS;
+
+class TimingStats {
+public:
+    TimingStats() : buckets(TIMING_BUCKETS + 1) {}
+
+    void record(uint64_t ns)
+    {
+        buckets[bucketOf(ns)]++;
+        samples++;
+        total += ns;
+        largest = std::max(largest, ns);
+    }
+
+    uint64_t count() const
+    {
+        return samples;
+    }
+
+    double meanNs() const
+    {
+        return samples ? (double)total / samples : 0;
+    }
+
+    uint64_t maxNs() const
+    {
+        return largest;
+    }
+
+    // Highest value in the bucket holding the given fraction of samples.
+    uint64_t percentileNs(double p) const
+    {
+        uint64_t target = (uint64_t)std::ceil(p * samples);
+        uint64_t seen = 0;
+        for (int i = 0; i < TIMING_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen >= target && seen > 0) {
+                return std::min(highestIn(i), largest);
+            }
+        }
+        return largest;
+    }
+
+    void print(std::ostream& out, const char* name) const
+    {
+        out << name << ": " << samples << " samples, mean " << std::fixed << std::setprecision(1) << meanNs() / 1000
+            << " us, p50 " << percentileNs(0.50) / 1000.0 << " us, p99 " << percentileNs(0.99) / 1000.0 << " us, p99.9 "
+            << percentileNs(0.999) / 1000.0 << " us, max " << largest / 1000.0 << " us" << std::endl;
+    }
+
+private:
+    std::vector<uint32_t> buckets;
+    uint64_t samples = 0;
+    uint64_t total = 0;
+    uint64_t largest = 0;
+
+    static int bucketOf(uint64_t ns)
+    {
+        if (ns < 2 * TIMING_SUB_BUCKETS) {
+            return (int)ns;
+        }
+        int shift = 63 - __builtin_clzll(ns) - 6;
+        if (shift > TIMING_MAX_SHIFT) {
+            return TIMING_BUCKETS;
+        }
+        return 2 * TIMING_SUB_BUCKETS + (shift - 1) * TIMING_SUB_BUCKETS + (int)(ns >> shift) - TIMING_SUB_BUCKETS;
+    }
+
+    static uint64_t highestIn(int bucket)
+    {
+        if (bucket < 2 * TIMING_SUB_BUCKETS) {
+            return bucket;
+        }
+        int shift = (bucket - 2 * TIMING_SUB_BUCKETS) / TIMING_SUB_BUCKETS + 1;
+        uint64_t mantissa = (bucket - 2 * TIMING_SUB_BUCKETS) % TIMING_SUB_BUCKETS + TIMING_SUB_BUCKETS;
+        return ((mantissa + 1) << shift) - 1;
+    }
+};
+
+inline uint64_t elapsedNanos(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+    return to > from ? (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count() : 0;
+}
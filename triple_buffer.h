@@ -0,0 +1,54 @@
+#pragma once
+
+// Lock-free single-writer / single-reader triple buffer. The writer fills
+// back(), then publish() swaps it with the shared middle slot; the reader
+// calls update() to swap the middle slot into front() if something new
+// was published. Neither side ever waits for the other: the writer always
+// has a free slot and the reader always sees the latest complete value.
+
+#include <bits/stdc++.h>
+
+template <class T>
+class TripleBuffer {
+public:
+    // Writer side.
+    T& back()
+    {
+        return slots[backIndex];
+    }
+
+    void publish()
+    {
+        backIndex = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader side. Returns true if front() changed.
+    bool update()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T& front() const
+    {
+        return slots[frontIndex];
+    }
+
+    // For giving each slot its storage before either side starts.
+    T& slot(int index)
+    {
+        return slots[index];
+    }
+
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4;
+
+    T slots[3];
+    int backIndex = 0;
+    int frontIndex = 1;
+    std::atomic<int> middle{2};
+};
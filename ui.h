@@ -0,0 +1,278 @@
+#pragma once
+
+// Retained-mode menu screens. Images and text labels are rasterized once
+// and cached as textures; a Menu keeps its buttons as a list of rects,
+// sleeps in SDL_WaitEvent and only redraws when hover, press or window
+// state actually changes, so an idle menu presents no frames at all.
+// Menus draw in scene coordinates through logicalScreen().
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_ttf.h>
+#include <bits/stdc++.h>
+#include "resources.h"
+#include "logical_screen.h"
+
+const int MENU_QUIT = -2;
+const int MENU_NONE = -1;
+
+class UiCache {
+public:
+    ~UiCache()
+    {
+        clear();
+    }
+
+    SDL_Texture* image(SDL_Renderer* renderer, const std::string& path)
+    {
+        use(renderer);
+        auto it = textures.find("image:" + path);
+        if (it != textures.end()) {
+            return it->second.get();
+        }
+
+        SDL_Surface* surface = IMG_Load(path.c_str());
+        if (!surface) {
+            std::cout << "Error: Could not load image " << path << " " << IMG_GetError() << std::endl;
+            return nullptr;
+        }
+        TextureHandle& texture = textures["image:" + path];
+        texture = ownTexture(SDL_CreateTextureFromSurface(renderer, surface));
+        SDL_FreeSurface(surface);
+        return texture.get();
+    }
+
+    SDL_Texture* text(SDL_Renderer* renderer, TTF_Font* font, const std::string& label)
+    {
+        use(renderer);
+        auto it = textures.find("text:" + label);
+        if (it != textures.end()) {
+            return it->second.get();
+        }
+
+        SDL_Color white = {255, 255, 255, 255};
+        SDL_Surface* surface = TTF_RenderText_Solid(font, label.c_str(), white);
+        if (!surface) {
+            std::cout << "Error: Could not render text " << label << " " << TTF_GetError() << std::endl;
+            return nullptr;
+        }
+        TextureHandle& texture = textures["text:" + label];
+        texture = ownTexture(SDL_CreateTextureFromSurface(renderer, surface));
+        SDL_FreeSurface(surface);
+        return texture.get();
+    }
+
+    void clear()
+    {
+        textures.clear();
+        owner = nullptr;
+    }
+
+private:
+    SDL_Renderer* owner = nullptr;
+    std::unordered_map<std::string, TextureHandle> textures;
+
+    // Textures belong to one renderer; start over if we are handed another.
+    void use(SDL_Renderer* renderer)
+    {
+        if (owner != renderer) {
+            clear();
+            owner = renderer;
+        }
+    }
+};
+
+inline UiCache& uiCache()
+{
+    static UiCache cache;
+    return cache;
+}
+
+struct Button {
+    SDL_Rect rect;
+    SDL_Texture* label;
+    int labelX, labelY;
+    SDL_Color color;
+    bool hovered = false;
+    bool pressed = false;
+};
+
+struct Label {
+    SDL_Texture* texture;
+    int x, y;
+};
+
+class Menu {
+public:
+    SDL_Texture* background = nullptr;
+    std::vector<Label> labels;
+    std::vector<Button> buttons;
+    uint32_t framesPresented = 0;
+    std::function<void()> onFirstPresent; // runs once the first frame is on screen
+
+    void addButton(SDL_Renderer* renderer, TTF_Font* font, SDL_Rect rect, const std::string& text, int labelX, int labelY, SDL_Color color)
+    {
+        Button b;
+        b.rect = rect;
+        b.label = uiCache().text(renderer, font, text);
+        b.labelX = labelX;
+        b.labelY = labelY;
+        b.color = color;
+        buttons.push_back(b);
+    }
+
+    // One-off text such as a score: rasterized once for this menu, not cached.
+    void addText(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, int x, int y)
+    {
+        SDL_Color white = {255, 255, 255, 255};
+        SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), white);
+        if (!surface) {
+            return;
+        }
+        owned.push_back(ownTexture(SDL_CreateTextureFromSurface(renderer, surface)));
+        SDL_FreeSurface(surface);
+        labels.push_back({owned.back().get(), x, y});
+    }
+
+    // x, y in window coordinates.
+    int hitTest(int x, int y) const
+    {
+        logicalScreen().toLogical(x, y);
+        SDL_Point p = {x, y};
+        for (size_t i = 0; i < buttons.size(); i++) {
+            if (SDL_PointInRect(&p, &buttons[i].rect)) {
+                return (int)i;
+            }
+        }
+        return MENU_NONE;
+    }
+
+    // Blocks until a button is clicked (returns its index) or the window
+    // is closed (returns MENU_QUIT).
+    int run(SDL_Renderer* renderer)
+    {
+        bool dirty = true;
+        while (true) {
+            if (dirty) {
+                render(renderer);
+                dirty = false;
+            }
+
+            SDL_Event event;
+            if (!SDL_WaitEvent(&event)) {
+                continue;
+            }
+            int clicked = handleEvent(event, dirty);
+            if (clicked != MENU_NONE) {
+                return clicked;
+            }
+        }
+    }
+
+private:
+    std::vector<TextureHandle> owned;
+
+    int handleEvent(const SDL_Event& event, bool& dirty)
+    {
+        switch (event.type) {
+            case SDL_QUIT:
+                return MENU_QUIT;
+
+            case SDL_WINDOWEVENT:
+                if (event.window.event == SDL_WINDOWEVENT_LEAVE) {
+                    dirty |= setHover(MENU_NONE);
+                } else if (event.window.event == SDL_WINDOWEVENT_EXPOSED || event.window.event == SDL_WINDOWEVENT_SHOWN ||
+                           event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                    dirty = true;
+                }
+                break;
+
+            // Some renderers lose what was drawn into textures on a resize.
+            case SDL_RENDER_TARGETS_RESET:
+                dirty = true;
+                break;
+
+            case SDL_MOUSEMOTION:
+                dirty |= setHover(hitTest(event.motion.x, event.motion.y));
+                break;
+
+            case SDL_MOUSEBUTTONDOWN:
+                if (event.button.button == SDL_BUTTON_LEFT) {
+                    int hit = hitTest(event.button.x, event.button.y);
+                    if (hit != MENU_NONE) {
+                        buttons[hit].pressed = true;
+                        dirty = true;
+                    }
+                }
+                break;
+
+            case SDL_MOUSEBUTTONUP:
+                if (event.button.button == SDL_BUTTON_LEFT) {
+                    int hit = hitTest(event.button.x, event.button.y);
+                    bool clicked = hit != MENU_NONE && buttons[hit].pressed;
+                    for (Button& b : buttons) {
+                        dirty |= b.pressed;
+                        b.pressed = false;
+                    }
+                    if (clicked) {
+                        return hit;
+                    }
+                }
+                break;
+        }
+        return MENU_NONE;
+    }
+
+    bool setHover(int hit)
+    {
+        bool changed = false;
+        for (size_t i = 0; i < buttons.size(); i++) {
+            bool hovered = (int)i == hit;
+            changed |= buttons[i].hovered != hovered;
+            buttons[i].hovered = hovered;
+        }
+        return changed;
+    }
+
+    void render(SDL_Renderer* renderer)
+    {
+        logicalScreen().begin(renderer);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        if (background) {
+            SDL_RenderCopy(renderer, background, nullptr, nullptr);
+        }
+
+        for (const Label& l : labels) {
+            drawTexture(renderer, l.texture, l.x, l.y);
+        }
+
+        for (const Button& b : buttons) {
+            SDL_Color c = b.color;
+            if (b.pressed) {
+                c = {(Uint8)(c.r / 2), (Uint8)(c.g / 2), (Uint8)(c.b / 2), c.a};
+            } else if (b.hovered) {
+                c = {(Uint8)std::min(255, c.r + 60), (Uint8)std::min(255, c.g + 60), (Uint8)std::min(255, c.b + 60), c.a};
+            }
+            SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+            SDL_RenderFillRect(renderer, &b.rect);
+            drawTexture(renderer, b.label, b.rect.x + b.labelX, b.rect.y + b.labelY);
+        }
+
+        logicalScreen().present(renderer);
+        framesPresented++;
+        if (framesPresented == 1 && onFirstPresent) {
+            onFirstPresent();
+        }
+    }
+
+    static void drawTexture(SDL_Renderer* renderer, SDL_Texture* texture, int x, int y)
+    {
+        if (!texture) {
+            return;
+        }
+        SDL_Rect rect = {x, y, 0, 0};
+        SDL_QueryTexture(texture, nullptr, nullptr, &rect.w, &rect.h);
+        SDL_RenderCopy(renderer, texture, nullptr, &rect);
+    }
+};